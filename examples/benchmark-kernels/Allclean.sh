@@ -0,0 +1,3 @@
+rm atom.in
+rm bench_*.json
+rm log*.lammps
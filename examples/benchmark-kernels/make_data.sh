@@ -0,0 +1,85 @@
+#!/bin/bash
+# Writes a synthetic data file for Inputscript.lammps
+#   ./make_data.sh NNU NX > atom.in
+# NNU = # of nutrients (>= 5, the first five are the monod nutrients)
+# NX  = # of grid cells per side of the 1e-4 m cubic domain
+# One HET cell of diameter 1.4e-6 m, above the division diameter, is placed
+# at the centre of every grid cell of the lower quarter of the domain.
+
+nnu=${1:-5}
+nx=${2:-32}
+
+if [ $nnu -lt 5 ]; then
+  echo "make_data.sh: at least 5 nutrients are required" >&2
+  exit 1
+fi
+
+nz=$(( nx / 4 ))
+natoms=$(( nx * nx * nz ))
+
+echo ""
+echo "  NUFEB kernel benchmark"
+echo ""
+echo "       $natoms atoms"
+echo "       2 atom types"
+echo "       $nnu nutrients"
+echo ""
+echo "   0.0e-04   1e-04  xlo xhi"
+echo "   0.0e-04   1e-04  ylo yhi"
+echo "   0.0e-04   1e-04  zlo zhi"
+echo ""
+echo " Atoms"
+echo ""
+awk -v nx=$nx -v nz=$nz 'BEGIN {
+  h = 1e-4 / nx; id = 1
+  for (k = 0; k < nz; k++)
+    for (j = 0; j < nx; j++)
+      for (i = 0; i < nx; i++)
+        printf "     %d 1 1.4e-6 150 %.6e %.6e %.6e 1.4e-6\n", id++, (i + 0.5) * h, (j + 0.5) * h, (k + 0.5) * h
+}'
+echo ""
+echo " Nutrients"
+echo ""
+names=(sub o2 no2 no3 nh4)
+for (( i = 1; i <= nnu; i++ )); do
+  name=${names[$((i - 1))]:-s$i}
+  echo "     $i $name l 1e-4 1e-4 1e-4 1e-4 1e-4 1e-4 1e-4"
+done
+echo ""
+echo " Type Name"
+echo ""
+echo "     1 het"
+echo "     2 eps"
+echo ""
+echo " Diffusion Coeffs"
+echo ""
+for (( i = 1; i <= nnu; i++ )); do
+  name=${names[$((i - 1))]:-s$i}
+  echo "     $name 1.15e-9"
+done
+echo ""
+echo " Ks"
+echo ""
+zeros=$(for (( i = 2; i <= nnu; i++ )); do printf " 0"; done)
+echo "     het 3.5e-5$zeros"
+echo "     eps 0$zeros"
+echo ""
+echo " Growth Rate"
+echo ""
+echo "     het 0.00028"
+echo "     eps 0"
+echo ""
+echo " Yield"
+echo ""
+echo "     het 0.61"
+echo "     eps 0.18"
+echo ""
+echo " Maintenance"
+echo ""
+echo "     het 0"
+echo "     eps 0"
+echo ""
+echo " Decay"
+echo ""
+echo "     het 0"
+echo "     eps 0"
@@ -0,0 +1,15 @@
+#!/bin/bash
+# Runs the kernel benchmark over grid sizes and nutrient counts
+#   LMP="mpirun -np 4 lmp_mpi" ./run.sh
+# Results are written to bench_<nutrients>_<nx>.json
+
+LMP=${LMP:-lmp_mpi}
+NREPEAT=${NREPEAT:-20}
+
+for nnu in 5 8 12; do
+  for nx in 16 32 64; do
+    ./make_data.sh $nnu $nx > atom.in
+    $LMP -var nx $nx -var nrepeat $NREPEAT -var json bench_${nnu}_${nx}.json \
+      -in Inputscript.lammps -log log_${nnu}_${nx}.lammps
+  done
+done
@@ -0,0 +1,8 @@
+rm snapshot_*
+rm grid_*
+rm dump_*
+rm atom_*
+rm slurm-*
+rm -rf Results
+rm output.lammps
+rm log.lammps
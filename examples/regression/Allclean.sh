@@ -0,0 +1,3 @@
+rm log.*
+rm results.json
+rm log.lammps
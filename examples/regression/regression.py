@@ -0,0 +1,230 @@
+#!/usr/bin/env python
+"""Performance and accuracy regression for the IWA benchmark cases.
+
+Runs every case x grid x coupling combination of the matrix below, extracts
+the benchmark observables reported by fix verify, the solver statistics and
+the wall time of each run, and compares them against baseline.json:
+
+  MPIRUN="mpirun -np 4" LMP=lmp_mpi ./regression.py           # check
+  MPIRUN="mpirun -np 4" LMP=lmp_mpi ./regression.py --update  # new baseline
+
+baseline.json is machine specific and not part of the repository: record
+it once with --update on the machine the suite runs on, from a build of
+the reference version, before checking any change against it.
+
+A run fails when it has no entry in baseline.json, when an observable
+deviates from its baseline by more than --rtol, or when its loop time is
+more than --slowdown times the baseline.
+Each run also checks the # of diffusion sweeps of each nutrient, and
+adapt_demflag.lammps checks that adaptive biological steps resume after a
+demflag phase.
+BM2 is not part of the suite as it needs the nufebFoam coupling.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+CASES = ['bm1', 'bm3']
+GRIDS = [(40, 60), (80, 120)]
+COUPLINGS = ['picard', 'anderson', 'jfnk']
+
+# thermo columns compared for accuracy, in the order of fix verify's vector
+OBSERVABLES = ['sub_bulk', 'sub_base', 'o2_bulk', 'o2_base', 'nh4_bulk',
+               'nh4_base', 'ssurf', 'maxz', 'mass', 'sub_flux', 'n_balance']
+
+# compute kinetics/stats: global entries, then three entries per nutrient
+KSTATS = 7
+KSTATS_NU = ['conv', 'res', 'sweeps']
+
+
+def run_name(case, grid, coupling):
+  return '%s-%dx%d-%s' % (case, grid[0], grid[1], coupling)
+
+
+def parse_log(path):
+  """Return the last thermo row keyed by column, the loop time and the
+  average time of each NUFEB phase."""
+  header, columns, loop, phases = None, None, None, {}
+  in_phases = False
+  with open(path) as f:
+    for line in f:
+      words = line.split()
+      if words and words[0] == 'Step':
+        header = words
+        continue
+      if header and len(words) == len(header):
+        try:
+          columns = dict(zip(header, [float(w) for w in words]))
+        except ValueError:
+          pass
+      m = re.match(r'Loop time of (\S+)', line)
+      if m:
+        loop = float(m.group(1))
+        header = None
+      if line.startswith('NUFEB timing breakdown'):
+        in_phases = True
+        continue
+      if in_phases:
+        fields = line.split('|')
+        if len(fields) == 6 and fields[0].strip() != 'Section':
+          phases[fields[0].strip()] = float(fields[2])
+        elif not words and phases:
+          in_phases = False
+  if columns is None or loop is None:
+    return None
+  result = {'loop': loop, 'phases': phases}
+  for k, v in columns.items():
+    m = re.match(r'f_vf1\[(\d+)\]', k)
+    if m:
+      result[OBSERVABLES[int(m.group(1)) - 1]] = v
+    m = re.match(r'c_kstat\[(\d+)\]', k)
+    if m:
+      n = int(m.group(1)) - 1
+      if n == 0:
+        result['iter'] = v
+      elif n == 1:
+        result['nevals'] = v
+      elif n >= KSTATS:
+        nu = (n - KSTATS) // len(KSTATS_NU) + 1
+        result['%s_%d' % (KSTATS_NU[(n - KSTATS) % len(KSTATS_NU)], nu)] = v
+  return result
+
+
+def check_sweeps(name, result):
+  """A nutrient is swept at most once per iteration, and is skipped only
+  between converging and the next reaction evaluation."""
+  failures = []
+  nu = 1
+  while 'sweeps_%d' % nu in result:
+    sweeps, conv = result['sweeps_%d' % nu], result['conv_%d' % nu]
+    if sweeps > result.get('iter', 0):
+      failures.append('%s: nutrient %d swept %d times in %d iterations' %
+                      (name, nu, sweeps, result['iter']))
+    elif conv > result.get('iter', 0):
+      failures.append('%s: nutrient %d converged at iteration %d of %d' %
+                      (name, nu, conv, result['iter']))
+    nu += 1
+  return failures
+
+
+def run(case, grid, coupling, args):
+  name = run_name(case, grid, coupling)
+  log = 'log.' + name
+  cmd = args.mpirun.split() + [args.lmp,
+         '-var', 'case', case, '-var', 'nx', str(grid[0]),
+         '-var', 'nz', str(grid[1]), '-var', 'coupling', coupling,
+         '-var', 'nsteps', str(args.nsteps),
+         '-in', 'Inputscript.lammps', '-log', log, '-screen', 'none']
+  subprocess.call(cmd)
+  if not os.path.exists(log):
+    return None
+  return parse_log(log)
+
+
+def check_adapt_demflag(args):
+  """Run adapt_demflag.lammps and return the failures: with adaptive
+  biological steps, kinetics must resume once the demflag phase ends."""
+  log = 'log.adapt_demflag'
+  cmd = args.mpirun.split() + [args.lmp, '-in', 'adapt_demflag.lammps',
+                               '-log', log, '-screen', 'none']
+  subprocess.call(cmd)
+  if not os.path.exists(log):
+    return ['adapt_demflag: run failed, see ' + log]
+  resumed, nbio = False, 0
+  with open(log) as f:
+    for line in f:
+      if line.startswith('REGRESSION resume'):
+        resumed = True
+      elif resumed and line.startswith('biological timestep'):
+        nbio += 1
+  if not resumed:
+    return ['adapt_demflag: run did not finish, see ' + log]
+  if nbio == 0:
+    return ['adapt_demflag: no biological step after the demflag phase']
+  return []
+
+
+def compare(name, result, base, args):
+  failures = []
+  for key in OBSERVABLES:
+    if key not in base or key not in result:
+      continue
+    ref = base[key]
+    scale = max(abs(ref), args.atol)
+    if abs(result[key] - ref) > args.rtol * scale:
+      failures.append('%s: %s = %g, baseline %g' % (name, key, result[key], ref))
+  if result['loop'] > args.slowdown * base['loop']:
+    failures.append('%s: loop time %g s, baseline %g s' %
+                    (name, result['loop'], base['loop']))
+  return failures
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__,
+                                   formatter_class=argparse.RawDescriptionHelpFormatter)
+  parser.add_argument('--update', action='store_true',
+                      help='overwrite baseline.json with the results of this run')
+  parser.add_argument('--baseline', default='baseline.json')
+  parser.add_argument('--rtol', type=float, default=1e-3,
+                      help='relative tolerance of the benchmark observables')
+  parser.add_argument('--atol', type=float, default=1e-12,
+                      help='magnitude below which observables are compared absolutely')
+  parser.add_argument('--slowdown', type=float, default=1.2,
+                      help='allowed ratio of loop time over the baseline')
+  parser.add_argument('--nsteps', type=int, default=3600)
+  parser.add_argument('--cases', nargs='+', default=CASES)
+  parser.add_argument('--couplings', nargs='+', default=COUPLINGS)
+  args = parser.parse_args()
+  args.mpirun = os.environ.get('MPIRUN', 'mpirun -np 4')
+  args.lmp = os.environ.get('LMP', 'lmp_mpi')
+
+  baseline = {}
+  if os.path.exists(args.baseline):
+    with open(args.baseline) as f:
+      baseline = json.load(f)
+  elif not args.update:
+    print('FAIL %s not found, run with --update to create it' % args.baseline)
+    return 1
+
+  results, failures = {}, []
+  for case in args.cases:
+    for grid in GRIDS:
+      for coupling in args.couplings:
+        name = run_name(case, grid, coupling)
+        result = run(case, grid, coupling, args)
+        if result is None:
+          failures.append('%s: run failed, see log.%s' % (name, name))
+          continue
+        results[name] = result
+        failures += check_sweeps(name, result)
+        print('%-24s loop %10.3f s  iter %6d  sub_flux %e' %
+              (name, result['loop'], result.get('iter', 0), result.get('sub_flux', 0)))
+        if not args.update:
+          if baseline.get(name):
+            failures += compare(name, result, baseline[name], args)
+          else:
+            failures.append('%s: no baseline in %s, run with --update' %
+                            (name, args.baseline))
+
+  failures += check_adapt_demflag(args)
+
+  with open('results.json', 'w') as f:
+    json.dump(results, f, indent=2, sort_keys=True)
+
+  if args.update:
+    baseline.update(results)
+    with open(args.baseline, 'w') as f:
+      json.dump(baseline, f, indent=2, sort_keys=True)
+    print('baseline written to %s' % args.baseline)
+
+  for failure in failures:
+    print('FAIL ' + failure)
+  return 1 if failures else 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
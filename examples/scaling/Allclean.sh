@@ -0,0 +1,3 @@
+rm log.*
+rm *.csv
+rm log.lammps
@@ -0,0 +1,24 @@
+#!/bin/bash
+# Collects the avg time of each NUFEB phase from the last timing breakdown
+# of each log into a CSV file
+#   ./collect.sh log.weak.* > weak.csv
+
+echo -n "log,procs,atoms,loop"
+first=1
+for log in "$@"; do
+  awk -v logname=$log -v header=$first '
+    /^Loop time of/ { loop = $4; procs = $6; atoms = $12 }
+    /^NUFEB timing breakdown/ { n = 0; inside = 1; next }
+    inside && /^-----/ { table = 1; next }
+    inside && table && /\|/ {
+      split($0, f, "|"); name = f[1]; gsub(/ /, "", name)
+      names[n] = name; avg[n] = f[3] + 0; n++; next }
+    inside && table { inside = 0; table = 0 }
+    END {
+      if (header) { for (i = 0; i < n; i++) printf ",%s", names[i]; printf "\n" }
+      printf "%s,%s,%s,%s", logname, procs, atoms, loop
+      for (i = 0; i < n; i++) printf ",%g", avg[i]
+      printf "\n"
+    }' $log
+  first=0
+done
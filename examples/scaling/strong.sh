@@ -0,0 +1,16 @@
+#!/bin/bash
+# Strong scaling: a fixed 6e-4 x 6e-4 m domain with NTOTAL cells
+#   MPIRUN="mpirun -np" LMP=lmp_mpi PPN=32 NTOTAL=1000000 ./strong.sh 1 4 16 64
+# The arguments are the # of procs. Set PPN to place that many procs per
+# node (OpenMPI --map-by syntax).
+
+MPIRUN=${MPIRUN:-"mpirun -np"}
+LMP=${LMP:-lmp_mpi}
+NTOTAL=${NTOTAL:-1000000}
+LX=${LX:-6e-4}
+MAP=${PPN:+--map-by ppr:$PPN:node}
+
+for n in ${@:-1 4 16}; do
+  $MPIRUN $n $MAP $LMP -var lx $LX -var ly $LX -var natoms $NTOTAL \
+    -in Inputscript.lammps -log log.strong.$n
+done
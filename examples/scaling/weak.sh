@@ -0,0 +1,17 @@
+#!/bin/bash
+# Weak scaling: every proc owns a 1.5e-4 x 1.5e-4 m column with NPER cells
+#   MPIRUN="mpirun -np" LMP=lmp_mpi PPN=32 NPER=25000 ./weak.sh 1 2 4 8
+# The arguments are the # of procs per side, procs are laid out P x P x 1.
+# Set PPN to place that many procs per node (OpenMPI --map-by syntax).
+
+MPIRUN=${MPIRUN:-"mpirun -np"}
+LMP=${LMP:-lmp_mpi}
+NPER=${NPER:-25000}
+MAP=${PPN:+--map-by ppr:$PPN:node}
+
+for p in ${@:-1 2 4}; do
+  n=$(( p * p ))
+  lx=$(awk -v p=$p 'BEGIN { printf "%g", p * 1.5e-4 }')
+  $MPIRUN $n $MAP $LMP -var lx $lx -var ly $lx -var natoms $(( NPER * n )) \
+    -in Inputscript.lammps -log log.weak.$n
+done
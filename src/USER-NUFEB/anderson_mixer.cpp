@@ -0,0 +1,175 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#include "anderson_mixer.h"
+
+#include <math.h>
+
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+AndersonMixer::AndersonMixer(LAMMPS *lmp, int depth) : Pointers(lmp)
+{
+  m = depth;
+  n = nmax = 0;
+  k = nhist = head = 0;
+
+  x = f = g = NULL;
+  df = dg = NULL;
+
+  memory->create(a, (m + 1) * (m + 1), "anderson:a");
+  memory->create(b, 2 * m + 2, "anderson:b");
+  memory->create(gamma, m, "anderson:gamma");
+  memory->create(sums, m * m + m, "anderson:sums");
+}
+
+/* ---------------------------------------------------------------------- */
+
+AndersonMixer::~AndersonMixer()
+{
+  memory->destroy(x);
+  memory->destroy(f);
+  memory->destroy(g);
+  memory->destroy(df);
+  memory->destroy(dg);
+  memory->destroy(a);
+  memory->destroy(b);
+  memory->destroy(gamma);
+  memory->destroy(sums);
+}
+
+/* ----------------------------------------------------------------------
+ start a new sequence with n local entries
+ ------------------------------------------------------------------------- */
+
+void AndersonMixer::reset(int nlocal)
+{
+  n = nlocal;
+  k = nhist = head = 0;
+
+  if (n > nmax) {
+    nmax = n;
+    memory->destroy(x);
+    memory->destroy(f);
+    memory->destroy(g);
+    memory->destroy(df);
+    memory->destroy(dg);
+    memory->create(x, nmax, "anderson:x");
+    memory->create(f, nmax, "anderson:f");
+    memory->create(g, nmax, "anderson:g");
+    memory->create(df, m, nmax, "anderson:df");
+    memory->create(dg, m, nmax, "anderson:dg");
+  }
+}
+
+/* ----------------------------------------------------------------------
+ v holds G(x_k) on input and x_k+1 on output
+ ------------------------------------------------------------------------- */
+
+void AndersonMixer::mix(double *v)
+{
+  if (k++ == 0) {
+    for (int i = 0; i < n; i++) x[i] = v[i];
+    return;
+  }
+
+  // update differences with the new residual f_k = G(x_k) - x_k
+  if (k > 2) {
+    for (int i = 0; i < n; i++) {
+      double fi = v[i] - x[i];
+      df[head][i] = fi - f[i];
+      dg[head][i] = v[i] - g[i];
+    }
+    head = (head + 1) % m;
+    if (nhist < m) nhist++;
+  }
+  for (int i = 0; i < n; i++) {
+    f[i] = v[i] - x[i];
+    g[i] = v[i];
+  }
+
+  // minimise |f_k - dF gamma| through the normal equations
+  if (nhist > 0) {
+    int nn = nhist * nhist;
+    for (int p = 0; p < nhist; p++) {
+      for (int q = 0; q <= p; q++) {
+        double sum = 0.0;
+        for (int i = 0; i < n; i++) sum += df[p][i] * df[q][i];
+        sums[p * nhist + q] = sums[q * nhist + p] = sum;
+      }
+      double sum = 0.0;
+      for (int i = 0; i < n; i++) sum += df[p][i] * f[i];
+      sums[nn + p] = sum;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, sums, nn + nhist, MPI_DOUBLE, MPI_SUM, world);
+    for (int p = 0; p < nn; p++) a[p] = sums[p];
+    for (int p = 0; p < nhist; p++) b[p] = sums[nn + p];
+
+    if (solve(nhist)) {
+      for (int p = 0; p < nhist; p++) {
+        for (int i = 0; i < n; i++) v[i] -= gamma[p] * dg[p][i];
+      }
+    } else {
+      // singular history, restart from a plain Picard step
+      nhist = head = 0;
+    }
+  }
+
+  for (int i = 0; i < n; i++) x[i] = v[i];
+}
+
+/* ----------------------------------------------------------------------
+ solve a gamma = b of size p by Gaussian elimination with partial
+ pivoting, return 0 if the system is numerically singular
+ ------------------------------------------------------------------------- */
+
+int AndersonMixer::solve(int p)
+{
+  double scale = 0.0;
+  for (int i = 0; i < p; i++) scale = fmax(scale, fabs(a[i * p + i]));
+  if (scale == 0.0) return 0;
+
+  // light Tikhonov regularisation keeps nearly collinear histories usable
+  for (int i = 0; i < p; i++) a[i * p + i] += 1e-12 * scale;
+
+  for (int c = 0; c < p; c++) {
+    int piv = c;
+    for (int r = c + 1; r < p; r++)
+      if (fabs(a[r * p + c]) > fabs(a[piv * p + c])) piv = r;
+    if (fabs(a[piv * p + c]) < 1e-14 * scale) return 0;
+    if (piv != c) {
+      for (int j = 0; j < p; j++) {
+        double t = a[c * p + j];
+        a[c * p + j] = a[piv * p + j];
+        a[piv * p + j] = t;
+      }
+      double t = b[c];
+      b[c] = b[piv];
+      b[piv] = t;
+    }
+    for (int r = c + 1; r < p; r++) {
+      double l = a[r * p + c] / a[c * p + c];
+      for (int j = c; j < p; j++) a[r * p + j] -= l * a[c * p + j];
+      b[r] -= l * b[c];
+    }
+  }
+
+  for (int r = p - 1; r >= 0; r--) {
+    double sum = b[r];
+    for (int j = r + 1; j < p; j++) sum -= a[r * p + j] * gamma[j];
+    gamma[r] = sum / a[r * p + r];
+  }
+
+  return 1;
+}
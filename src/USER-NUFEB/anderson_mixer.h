@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifndef SRC_ANDERSON_MIXER_H
+#define SRC_ANDERSON_MIXER_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// Anderson acceleration of a fixed-point iteration x = G(x) whose vectors
+// are distributed over the MPI ranks.
+//
+// reset() starts a new sequence of n local entries. Each call to mix()
+// takes G(x_k) in v and overwrites it with the accelerated iterate x_k+1,
+// which minimises the combination of the last m residuals G(x) - x.
+// The first call only records x_0.
+
+class AndersonMixer : protected Pointers {
+ public:
+  AndersonMixer(class LAMMPS *, int);
+  ~AndersonMixer();
+  void reset(int);
+  void mix(double *);
+
+ private:
+  int m;                      // mixing depth
+  int n, nmax;                // # of local entries and allocated size
+  int k;                      // # of calls to mix() since reset()
+  int nhist;                  // # of stored differences
+  int head;                   // next history slot to overwrite
+
+  double *x;                  // last iterate
+  double *f;                  // last residual
+  double *g;                  // last G(x)
+  double **df;                // residual differences [m][n]
+  double **dg;                // G(x) differences [m][n]
+  double *a, *b, *gamma;      // least-squares system [m*m], [m], [m]
+  double *sums;              // local then global normal equations [m*m+m]
+
+  int solve(int);
+};
+
+}
+
+#endif
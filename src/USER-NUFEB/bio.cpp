@@ -21,6 +21,7 @@
 #include "force.h"
 #include "memory.h"
 #include "atom_vec_bio.h"
+#include "bio_timer.h"
 
 using namespace LAMMPS_NS;
 
@@ -55,6 +56,8 @@ BIO::BIO(LAMMPS *lmp) : Pointers(lmp)
   kla = NULL;
   mw = NULL;
 
+  timer = new BioTimer(lmp);
+
   /*
    * Dinika's edits
    * */
@@ -66,6 +69,8 @@ BIO::BIO(LAMMPS *lmp) : Pointers(lmp)
 
 BIO::~BIO()
 {
+  delete timer;
+
   memory->destroy(yield);
   memory->destroy(maintain);
   memory->destroy(decay);
@@ -54,6 +54,8 @@ class BIO : protected Pointers {
   int **nucharge;             // charge [nutrient][5charges]
   double *kla;                // mass Transfer Coefficient [nutrient]
 
+  class BioTimer *timer;      // wall time of the NUFEB phases
+
   /*
    * Dinika's edits
    * */
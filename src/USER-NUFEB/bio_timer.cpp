@@ -0,0 +1,286 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#include "bio_timer.h"
+
+#include <mpi.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "comm.h"
+#include "error.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+static const char *timer_names[BioTimer::NTIMERS] = {
+  "Reaction", "  pH", "  Energy", "Diffusion", "Halo", "Reduce", "Growth",
+  "Bulk", "Divide", "EPS", "Migrate", "Output"
+};
+
+/* ---------------------------------------------------------------------- */
+
+BioTimer::BioTimer(LAMMPS *lmp) : Pointers(lmp)
+{
+  ncounters = 0;
+  for (int j = 0; j < NCOUNTERS; j++) {
+    fd[j] = -1;
+    cindex[j] = -1;
+  }
+  reset();
+}
+
+/* ---------------------------------------------------------------------- */
+
+BioTimer::~BioTimer()
+{
+#if defined(__linux__)
+  for (int j = 0; j < NCOUNTERS; j++)
+    if (fd[j] >= 0) close(fd[j]);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   zero all timers, called at the start of a run
+------------------------------------------------------------------------- */
+
+void BioTimer::reset()
+{
+  for (int i = 0; i < NTIMERS; i++) {
+    wall[i] = 0.0;
+    tstart[i] = 0.0;
+    wmark[i] = 0.0;
+    for (int j = 0; j < NCOUNTERS; j++) {
+      count[i][j] = 0;
+      cstart[i][j] = 0;
+    }
+  }
+  trun = MPI_Wtime();
+}
+
+/* ----------------------------------------------------------------------
+   start a new lap of all timers
+------------------------------------------------------------------------- */
+
+void BioTimer::mark()
+{
+  for (int i = 0; i < NTIMERS; i++)
+    wmark[i] = wall[i];
+}
+
+/* ---------------------------------------------------------------------- */
+
+void BioTimer::start(int which)
+{
+  if (ncounters) read_counters(cstart[which]);
+  tstart[which] = MPI_Wtime();
+}
+
+/* ----------------------------------------------------------------------
+   accumulate the time since start(which), return it
+------------------------------------------------------------------------- */
+
+double BioTimer::stop(int which)
+{
+  double dt = MPI_Wtime() - tstart[which];
+  wall[which] += dt;
+
+  if (ncounters) {
+    uint64_t now[NCOUNTERS];
+    read_counters(now);
+    for (int j = 0; j < NCOUNTERS; j++)
+      count[which][j] += now[j] - cstart[which][j];
+  }
+  return dt;
+}
+
+/* ----------------------------------------------------------------------
+   open cycles, instructions and LLC misses as one perf event group, plus
+   the raw event fpcode as FP ops if fpcode >= 0; counters the kernel
+   refuses are left out with a warning
+------------------------------------------------------------------------- */
+
+void BioTimer::enable_counters(long fpcode)
+{
+#if defined(__linux__)
+  uint32_t types[NCOUNTERS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                               PERF_TYPE_HARDWARE, PERF_TYPE_RAW};
+  uint64_t configs[NCOUNTERS] = {PERF_COUNT_HW_CPU_CYCLES,
+                                 PERF_COUNT_HW_INSTRUCTIONS,
+                                 PERF_COUNT_HW_CACHE_MISSES,
+                                 (uint64_t) fpcode};
+  int nrequest = fpcode >= 0 ? NCOUNTERS : NCOUNTERS - 1;
+  int nfailed = 0;
+
+  for (int j = 0; j < nrequest; j++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = types[j];
+    attr.config = configs[j];
+    attr.disabled = (j == 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    int leader = (j == 0) ? -1 : fd[0];
+    fd[j] = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+    if (fd[j] < 0) {
+      nfailed++;
+      // without a leader there is no group to join
+      if (j == 0) break;
+    } else {
+      cindex[j] = ncounters++;
+    }
+  }
+
+  if (fd[0] < 0) {
+    ncounters = 0;
+    error->warning(FLERR, "Fix kinetics counters are not available, "
+                   "check /proc/sys/kernel/perf_event_paranoid");
+    return;
+  }
+  if (nfailed)
+    error->warning(FLERR, "Some fix kinetics counters are not available");
+
+  ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+  error->warning(FLERR, "Fix kinetics counters require Linux perf events");
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   current value of each counter, 0 for unavailable counters
+------------------------------------------------------------------------- */
+
+void BioTimer::read_counters(uint64_t *values)
+{
+  uint64_t buf[NCOUNTERS + 1];
+  for (int j = 0; j < NCOUNTERS; j++) values[j] = 0;
+
+#if defined(__linux__)
+  // group read layout: # of events followed by their values
+  if (read(fd[0], buf, sizeof(buf)) <= 0) return;
+  for (int j = 0; j < NCOUNTERS; j++)
+    if (cindex[j] >= 0 && cindex[j] < (int) buf[0])
+      values[j] = buf[cindex[j] + 1];
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   print the timers as min/avg/max over procs, in the same layout as
+   LAMMPS' loop summary, followed by the memory usage in bytes
+------------------------------------------------------------------------- */
+
+void BioTimer::report(double bytes)
+{
+  int nprocs = comm->nprocs;
+  double total = MPI_Wtime() - trun;
+  double tmin[NTIMERS], tmax[NTIMERS], tsum[NTIMERS];
+
+  MPI_Allreduce(wall, tmin, NTIMERS, MPI_DOUBLE, MPI_MIN, world);
+  MPI_Allreduce(wall, tmax, NTIMERS, MPI_DOUBLE, MPI_MAX, world);
+  MPI_Allreduce(wall, tsum, NTIMERS, MPI_DOUBLE, MPI_SUM, world);
+  MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_DOUBLE, MPI_MAX, world);
+
+  double mbytes = bytes / 1024.0 / 1024.0;
+  double mmin, mmax, msum;
+  MPI_Allreduce(&mbytes, &mmin, 1, MPI_DOUBLE, MPI_MIN, world);
+  MPI_Allreduce(&mbytes, &mmax, 1, MPI_DOUBLE, MPI_MAX, world);
+  MPI_Allreduce(&mbytes, &msum, 1, MPI_DOUBLE, MPI_SUM, world);
+
+  if (comm->me == 0) {
+    FILE *fp[2] = {screen, logfile};
+    for (int f = 0; f < 2; f++) {
+      if (fp[f] == NULL) continue;
+      fprintf(fp[f], "\nNUFEB timing breakdown:\n\n"
+              "Section |  min time  |  avg time  |  max time  |%%varavg| %%total\n"
+              "---------------------------------------------------------------\n");
+      for (int i = 0; i < NTIMERS; i++) {
+        double avg = tsum[i] / nprocs;
+        double varavg = avg > 0.0 ? 100.0 * (tmax[i] - tmin[i]) / avg : 0.0;
+        double pct = total > 0.0 ? 100.0 * avg / total : 0.0;
+        fprintf(fp[f], "%-8s| %10.4g | %10.4g | %10.4g | %5.1f | %6.2f\n",
+                timer_names[i], tmin[i], avg, tmax[i], varavg, pct);
+      }
+      fprintf(fp[f], "\nNUFEB kinetics memory usage per processor (Mbytes) = "
+              "%.4g | %.4g | %.4g\n", mmin, msum / nprocs, mmax);
+    }
+  }
+
+  // every proc enabled the same counters, but some may have failed to open
+  int flag = ncounters > 0, anyflag;
+  MPI_Allreduce(&flag, &anyflag, 1, MPI_INT, MPI_MAX, world);
+  if (anyflag) report_counters();
+}
+
+/* ----------------------------------------------------------------------
+   print the counters of each phase summed over procs to screen and log,
+   and the counters of each phase on each proc to the log
+------------------------------------------------------------------------- */
+
+void BioTimer::report_counters()
+{
+  int nprocs = comm->nprocs;
+  int n = NTIMERS * NCOUNTERS;
+  double *local = new double[n];
+  double *all = NULL;
+
+  for (int i = 0; i < NTIMERS; i++)
+    for (int j = 0; j < NCOUNTERS; j++)
+      local[i * NCOUNTERS + j] = (double) count[i][j];
+
+  if (comm->me == 0)
+    memory->create(all, nprocs * n, "bio_timer:all");
+  MPI_Gather(local, n, MPI_DOUBLE, all, n, MPI_DOUBLE, 0, world);
+  delete[] local;
+
+  if (comm->me != 0) return;
+
+  FILE *fp[2] = {screen, logfile};
+  for (int f = 0; f < 2; f++) {
+    if (fp[f] == NULL) continue;
+    fprintf(fp[f], "\nNUFEB hardware counters summed over procs:\n\n"
+            "Section |   cycles   |   instr    |  IPC  | LLC miss/kinstr |   FP ops\n"
+            "-----------------------------------------------------------------------\n");
+    for (int i = 0; i < NTIMERS; i++) {
+      double sum[NCOUNTERS] = {0.0};
+      for (int p = 0; p < nprocs; p++)
+        for (int j = 0; j < NCOUNTERS; j++)
+          sum[j] += all[p * n + i * NCOUNTERS + j];
+      double ipc = sum[CYCLES] > 0.0 ? sum[INSTRUCTIONS] / sum[CYCLES] : 0.0;
+      double mpki = sum[INSTRUCTIONS] > 0.0 ? 1000.0 * sum[LLC_MISSES] / sum[INSTRUCTIONS] : 0.0;
+      fprintf(fp[f], "%-8s| %10.4g | %10.4g | %5.2f | %15.3f | %10.4g\n",
+              timer_names[i], sum[CYCLES], sum[INSTRUCTIONS], ipc, mpki, sum[FP_OPS]);
+    }
+  }
+
+  if (logfile) {
+    fprintf(logfile, "\nNUFEB hardware counters per proc:\n\n"
+            "proc Section cycles instr LLC_misses FP_ops\n");
+    for (int p = 0; p < nprocs; p++)
+      for (int i = 0; i < NTIMERS; i++) {
+        double *c = &all[p * n + i * NCOUNTERS];
+        fprintf(logfile, "%d %s %.10g %.10g %.10g %.10g\n", p, timer_names[i] + strspn(timer_names[i], " "),
+                c[CYCLES], c[INSTRUCTIONS], c[LLC_MISSES], c[FP_OPS]);
+      }
+  }
+
+  memory->destroy(all);
+}
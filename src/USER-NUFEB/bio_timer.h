@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifndef SRC_BIO_TIMER_H
+#define SRC_BIO_TIMER_H
+
+#include <stdint.h>
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// Wall time of the NUFEB phases, which LAMMPS' Timer only accounts for as
+// "Modify". Timers accumulate over a run and are reported by fix kinetics
+// at the end of it, as min/avg/max over procs. pH and Energy are part of
+// Reaction. mark() starts a lap, which fix kinetics does at each biological
+// step so compute kinetics/stats can report the time of the last one.
+//
+// With enable_counters(), start() and stop() also sample Linux hardware
+// counters through perf_event_open: cycles, instructions, last level cache
+// misses and optionally a raw floating point event. Counters follow the
+// calling thread only, so OpenMP worker threads are not included.
+
+class BioTimer : protected Pointers {
+ public:
+  enum {REACTION, PH, ENERGY, DIFFUSION, HALO, REDUCE, GROWTH, BULK,
+        DIVIDE, EPS, MIGRATE, OUTPUT, NTIMERS};
+  enum {CYCLES, INSTRUCTIONS, LLC_MISSES, FP_OPS, NCOUNTERS};
+
+  BioTimer(class LAMMPS *);
+  ~BioTimer();
+
+  void reset();
+  void start(int);
+  double stop(int);
+  double get(int which) const { return wall[which]; }
+  void mark();
+  double lap(int which) const { return wall[which] - wmark[which]; }
+  void enable_counters(long);
+  void report(double);
+
+ private:
+  double wall[NTIMERS];            // accumulated wall time
+  double tstart[NTIMERS];          // wall time of the last start()
+  double wmark[NTIMERS];           // accumulated wall time at the last mark()
+  double trun;                     // wall time of the last reset()
+
+  int ncounters;                   // # of open counters, 0 = sampling disabled
+  int fd[NCOUNTERS];               // perf event file descriptors, fd[0] is the group leader
+  int cindex[NCOUNTERS];           // position of each counter in a group read, -1 if unavailable
+  uint64_t count[NTIMERS][NCOUNTERS];   // accumulated counts
+  uint64_t cstart[NTIMERS][NCOUNTERS];  // counts at the last start()
+
+  void read_counters(uint64_t *);
+  void report_counters();
+};
+
+}
+
+#endif
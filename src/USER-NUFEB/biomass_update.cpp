@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#include "biomass_update.h"
+
+#include <math.h>
+
+#include "atom.h"
+#include "atom_vec_bio.h"
+#include "comm.h"
+#include "math_const.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+using namespace MathConst;
+
+/* ---------------------------------------------------------------------- */
+
+BiomassUpdate::BiomassUpdate(LAMMPS *lmp) : Pointers(lmp)
+{
+  mode = NULL;
+  grow = NULL;
+  eps = NULL;
+  nmax = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+BiomassUpdate::~BiomassUpdate()
+{
+  memory->destroy(mode);
+  memory->destroy(grow);
+  memory->destroy(eps);
+}
+
+/* ----------------------------------------------------------------------
+ make room for n atoms
+ ------------------------------------------------------------------------- */
+
+void BiomassUpdate::reserve(int n)
+{
+  if (n <= nmax) return;
+  nmax = MAX(n, atom->nmax);
+  memory->destroy(mode);
+  memory->destroy(grow);
+  memory->destroy(eps);
+  memory->create(mode, nmax, "biomass_update:mode");
+  memory->create(grow, nmax, "biomass_update:grow");
+  memory->create(eps, nmax, "biomass_update:eps");
+}
+
+/* ----------------------------------------------------------------------
+ update mass and radius of atoms [0,n); both branches of the EPS shell
+ case are evaluated and selected, so the loop body has no control flow
+ ------------------------------------------------------------------------- */
+
+void BiomassUpdate::apply(int n, double eps_dens)
+{
+  AtomVecBio *avec = (AtomVecBio *) atom->style_match("bio");
+
+  double * __restrict rmass = atom->rmass;
+  double * __restrict radius = atom->radius;
+  double * __restrict outer_mass = avec->outer_mass;
+  double * __restrict outer_radius = avec->outer_radius;
+  const int * __restrict m = mode;
+  const double * __restrict g = grow;
+  const double * __restrict e = eps;
+
+  const double three_quarters_pi = (3.0 / (4.0 * MY_PI));
+  const double four_thirds_pi = 4.0 * MY_PI / 3.0;
+  const double inv_eps_dens = eps_dens > 0.0 ? 1.0 / eps_dens : 0.0;
+
+#if defined(_OPENMP)
+  #pragma omp parallel for simd num_threads(comm->nthreads) schedule(static)
+#endif
+  for (int i = 0; i < n; i++) {
+    double r = radius[i];
+    double r3 = r * r * r;
+    double ro = outer_radius[i];
+    double mass = rmass[i] * (1 + g[i]);
+    // core volume at constant density
+    double vol = four_thirds_pi * r3 * mass / rmass[i];
+    double rnew = cbrt(three_quarters_pi * vol);
+
+    double rs = m[i] == SHELL_GROWN ? rnew * rnew * rnew : r3;
+    double shell_mass = four_thirds_pi * (ro * ro * ro - rs) * eps_dens + e[i] * mass;
+    double shell_radius = cbrt(three_quarters_pi * (vol + shell_mass * inv_eps_dens));
+
+    bool shell = m[i] >= SHELL;
+    bool plain = m[i] == PLAIN;
+    rmass[i] = mass;
+    radius[i] = m[i] == FIXED ? r : rnew;
+    outer_mass[i] = shell ? shell_mass : (plain ? mass : outer_mass[i]);
+    outer_radius[i] = shell ? shell_radius : (plain ? rnew : ro);
+  }
+}
@@ -0,0 +1,52 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifndef SRC_BIOMASS_UPDATE_H
+#define SRC_BIOMASS_UPDATE_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// Per-particle mass and radius update shared by the growth fixes.
+//
+// The caller fills mode, grow and eps for atoms [0,n) and calls apply().
+// rmass is scaled by (1 + grow) at constant density and the radius is
+// recomputed according to mode:
+//
+//   FIXED        radius and outer shell are left unchanged
+//   CORE         radius is updated, outer shell is left unchanged
+//   PLAIN        radius is updated, outer shell collapses onto the core
+//   SHELL        radius is updated and eps * rmass is added to the EPS
+//                shell, whose previous mass is measured against the old radius
+//   SHELL_GROWN  as SHELL, but the previous shell mass is measured against
+//                the updated radius
+
+class BiomassUpdate : protected Pointers {
+ public:
+  enum {FIXED, CORE, PLAIN, SHELL, SHELL_GROWN};
+
+  int *mode;                  // update mode [atom]
+  double *grow;               // relative core mass increment [atom]
+  double *eps;                // EPS mass increment per unit core mass [atom]
+
+  BiomassUpdate(class LAMMPS *);
+  ~BiomassUpdate();
+  void reserve(int);
+  void apply(int, double);
+
+ private:
+  int nmax;
+};
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#include "compute_bio_kinetics_stats.h"
+
+#include <string.h>
+
+#include "bio.h"
+#include "bio_timer.h"
+#include "error.h"
+#include "memory.h"
+#include "modify.h"
+#include "update.h"
+
+#include "fix_bio_kinetics.h"
+#include "fix_bio_kinetics_diffusion.h"
+#include "fix_bio_kinetics_ph.h"
+
+using namespace LAMMPS_NS;
+
+// layout of the vector, followed by three entries per nutrient: the
+// iteration from which it stayed converged, its last residual over
+// tolerance and the # of diffusion sweeps it took
+enum {ITER, NEVALS, PH_ITER, NSKIP, TIME_REACTION, TIME_DIFFUSION, TIME_GROWTH, NSTATS};
+enum {NU_CONV, NU_RES, NU_SWEEPS, NSTATS_NU};
+
+/* ---------------------------------------------------------------------- */
+
+ComputeNufebKineticsStats::ComputeNufebKineticsStats(LAMMPS *lmp, int narg, char **arg) :
+  Compute(lmp, narg, arg)
+{
+  if (narg != 3) error->all(FLERR,"Illegal compute kinetics/stats command");
+
+  kinetics = NULL;
+  for (int j = 0; j < modify->nfix; j++) {
+    if (strcmp(modify->fix[j]->style,"kinetics") == 0) {
+      kinetics = static_cast<FixKinetics *>(modify->fix[j]);
+      break;
+    }
+  }
+
+  if (kinetics == NULL)
+    error->all(FLERR,"The fix kinetics command is required");
+
+  vector_flag = 1;
+  extvector = 0;
+  size_vector = NSTATS + NSTATS_NU * kinetics->bio->nnu;
+  memory->create(vector,size_vector,"compute:vector");
+}
+
+/* ---------------------------------------------------------------------- */
+
+ComputeNufebKineticsStats::~ComputeNufebKineticsStats()
+{
+  memory->destroy(vector);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeNufebKineticsStats::init()
+{
+  if (size_vector != NSTATS + NSTATS_NU * kinetics->bio->nnu)
+    error->all(FLERR,"Illegal compute kinetics/stats command: # of nutrients has changed");
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeNufebKineticsStats::compute_vector()
+{
+  invoked_vector = update->ntimestep;
+
+  int nnus = kinetics->bio->nnu;
+
+  vector[ITER] = kinetics->stat_iter;
+  vector[NEVALS] = kinetics->stat_nevals;
+  vector[NSKIP] = kinetics->nskip;
+
+  // Newton iterations are summed over all grids, times are the slowest proc
+  double iters = kinetics->ph ? (double) kinetics->ph->newton_iters : 0.0;
+  MPI_Allreduce(&iters, &vector[PH_ITER], 1, MPI_DOUBLE, MPI_SUM, world);
+
+  // times of the last biological step, halo exchange and residual
+  // reduction count as diffusion and bulk update as growth
+  BioTimer *timer = kinetics->bio->timer;
+  double times[3];
+  times[0] = timer->lap(BioTimer::REACTION);
+  times[1] = timer->lap(BioTimer::DIFFUSION) + timer->lap(BioTimer::HALO) +
+      timer->lap(BioTimer::REDUCE);
+  times[2] = timer->lap(BioTimer::GROWTH) + timer->lap(BioTimer::BULK);
+  MPI_Allreduce(times, &vector[TIME_REACTION], 3, MPI_DOUBLE, MPI_MAX, world);
+
+  for (int i = 1; i <= nnus; i++) {
+    double *nu = &vector[NSTATS + NSTATS_NU * (i - 1)];
+    nu[NU_CONV] = kinetics->stat_conv ? kinetics->stat_conv[i] : 0;
+    nu[NU_RES] = (kinetics->diffusion && kinetics->diffusion->nures) ?
+        kinetics->diffusion->nures[i] : 0.0;
+    nu[NU_SWEEPS] = kinetics->stat_sweeps ? kinetics->stat_sweeps[i] : 0;
+  }
+}
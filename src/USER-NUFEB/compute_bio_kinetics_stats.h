@@ -0,0 +1,52 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifdef COMPUTE_CLASS
+
+ComputeStyle(kinetics/stats,ComputeNufebKineticsStats)
+
+#else
+
+#ifndef LMP_COMPUTE_KINETICS_STATS_H
+#define LMP_COMPUTE_KINETICS_STATS_H
+
+#include "compute.h"
+
+namespace LAMMPS_NS {
+
+class ComputeNufebKineticsStats : public Compute {
+ public:
+  ComputeNufebKineticsStats(class LAMMPS *, int, char **);
+  ~ComputeNufebKineticsStats();
+  void init();
+  void compute_vector();
+
+ private:
+  class FixKinetics *kinetics;
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal compute kinetics/stats command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: The fix kinetics command is required
+
+Compute kinetics/stats reports the solver statistics of fix kinetics.
+
+*/
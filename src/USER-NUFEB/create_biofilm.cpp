@@ -0,0 +1,212 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#include "create_biofilm.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "atom.h"
+#include "atom_vec_bio.h"
+#include "bio.h"
+#include "comm.h"
+#include "domain.h"
+#include "error.h"
+#include "force.h"
+#include "lmptype.h"
+#include "math_const.h"
+#include "memory.h"
+#include "random_park.h"
+
+using namespace LAMMPS_NS;
+using namespace MathConst;
+
+/* ---------------------------------------------------------------------- */
+
+CreateBiofilm::CreateBiofilm(LAMMPS *lmp) : Pointers(lmp)
+{
+  nlayers = 0;
+  ltype = NULL;
+  llo = NULL;
+  lhi = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+CreateBiofilm::~CreateBiofilm()
+{
+  memory->destroy(ltype);
+  memory->destroy(llo);
+  memory->destroy(lhi);
+}
+
+/* ----------------------------------------------------------------------
+   create_biofilm N height seed keyword value ...
+
+   places N cells uniformly at random in the slab of the given height above
+   the lower z boundary. Each proc creates the cells of its own subdomain,
+   so the cost does not depend on the # of procs. Cells may overlap and are
+   expected to be relaxed by a short DEM run.
+------------------------------------------------------------------------- */
+
+void CreateBiofilm::command(int narg, char **arg)
+{
+  if (domain->box_exist == 0)
+    error->all(FLERR,"Create_biofilm command before simulation box is defined");
+  if (narg < 3) error->all(FLERR,"Illegal create_biofilm command");
+
+  AtomVecBio *avec = (AtomVecBio *) atom->style_match("bio");
+  if (!avec) error->all(FLERR,"Create_biofilm requires atom style bio");
+
+  bigint ntarget = force->bnumeric(FLERR,arg[0]);
+  double height = force->numeric(FLERR,arg[1]);
+  int seed = force->inumeric(FLERR,arg[2]);
+  if (ntarget < 0 || height <= 0.0 || seed <= 0)
+    error->all(FLERR,"Illegal create_biofilm command");
+
+  dmin = dmax = 1.0e-6;
+  density = 150;
+  eps_ratio = 1.0;
+  eps_density = 30;
+
+  int iarg = 3;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"layer") == 0) {
+      // layer name zlo zhi, bounds as fractions of the height
+      if (iarg + 4 > narg) error->all(FLERR,"Illegal create_biofilm command");
+      int t = avec->bio->find_typeid(arg[iarg + 1]);
+      if (t < 0) error->all(FLERR,"Create_biofilm type name does not exist");
+      memory->grow(ltype,nlayers + 1,"create_biofilm:ltype");
+      memory->grow(llo,nlayers + 1,"create_biofilm:llo");
+      memory->grow(lhi,nlayers + 1,"create_biofilm:lhi");
+      ltype[nlayers] = t;
+      llo[nlayers] = force->numeric(FLERR,arg[iarg + 2]);
+      lhi[nlayers] = force->numeric(FLERR,arg[iarg + 3]);
+      if (llo[nlayers] < 0.0 || lhi[nlayers] > 1.0 || llo[nlayers] >= lhi[nlayers])
+        error->all(FLERR,"Illegal create_biofilm command");
+      nlayers++;
+      iarg += 4;
+    } else if (strcmp(arg[iarg],"diameter") == 0) {
+      if (iarg + 3 > narg) error->all(FLERR,"Illegal create_biofilm command");
+      dmin = force->numeric(FLERR,arg[iarg + 1]);
+      dmax = force->numeric(FLERR,arg[iarg + 2]);
+      if (dmin <= 0.0 || dmax < dmin) error->all(FLERR,"Illegal create_biofilm command");
+      iarg += 3;
+    } else if (strcmp(arg[iarg],"density") == 0) {
+      if (iarg + 2 > narg) error->all(FLERR,"Illegal create_biofilm command");
+      density = force->numeric(FLERR,arg[iarg + 1]);
+      if (density <= 0.0) error->all(FLERR,"Illegal create_biofilm command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"eps") == 0) {
+      if (iarg + 3 > narg) error->all(FLERR,"Illegal create_biofilm command");
+      eps_ratio = force->numeric(FLERR,arg[iarg + 1]);
+      eps_density = force->numeric(FLERR,arg[iarg + 2]);
+      if (eps_ratio < 1.0 || eps_density <= 0.0)
+        error->all(FLERR,"Illegal create_biofilm command");
+      iarg += 3;
+    } else error->all(FLERR,"Illegal create_biofilm command");
+  }
+
+  // slab of this proc, in the biofilm
+  double lo[3], hi[3];
+  for (int i = 0; i < 3; i++) {
+    lo[i] = domain->sublo[i];
+    hi[i] = domain->subhi[i];
+  }
+  double ztop = MIN(domain->boxlo[2] + height, domain->boxhi[2]);
+  hi[2] = MIN(hi[2], ztop);
+  double myvol = 0.0;
+  if (hi[2] > lo[2])
+    myvol = (hi[0] - lo[0]) * (hi[1] - lo[1]) * (hi[2] - lo[2]);
+
+  // split N by volume so that the counts add up to N exactly
+  double total, before;
+  MPI_Allreduce(&myvol,&total,1,MPI_DOUBLE,MPI_SUM,world);
+  MPI_Scan(&myvol,&before,1,MPI_DOUBLE,MPI_SUM,world);
+  before -= myvol;
+  bigint ifirst = (bigint) floor(ntarget * (before / total) + 0.5);
+  bigint ilast = (bigint) floor(ntarget * ((before + myvol) / total) + 0.5);
+  if (comm->me == comm->nprocs - 1) ilast = ntarget;
+  bigint nmine = ilast - ifirst;
+
+  RanPark *random = new RanPark(lmp,seed + comm->me);
+  bigint nprevious = atom->nlocal;
+
+  for (bigint n = 0; n < nmine; n++) {
+    double coord[3];
+    for (int i = 0; i < 3; i++)
+      coord[i] = lo[i] + random->uniform() * (hi[i] - lo[i]);
+
+    double frac = (coord[2] - domain->boxlo[2]) / height;
+    int itype = pick_type(frac,random);
+    avec->create_atom(itype,coord);
+
+    int m = atom->nlocal - 1;
+    double radius = 0.5 * (dmin + random->uniform() * (dmax - dmin));
+    atom->radius[m] = radius;
+    atom->rmass[m] = 4.0 * MY_PI / 3.0 * radius * radius * radius * density;
+
+    double outer = radius;
+    if (eps_ratio > 1.0)
+      outer = radius * (1.0 + random->uniform() * (eps_ratio - 1.0));
+    avec->outer_radius[m] = outer;
+    avec->outer_mass[m] = 4.0 * MY_PI / 3.0 *
+        (outer * outer * outer - radius * radius * radius) * eps_density;
+  }
+
+  delete random;
+
+  // same bookkeeping as fix divide after inserting atoms
+  bigint nblocal = atom->nlocal;
+  MPI_Allreduce(&nblocal,&atom->natoms,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  if (atom->natoms < 0 || atom->natoms >= MAXBIGINT)
+    error->all(FLERR,"Too many total atoms");
+
+  if (atom->tag_enable)
+    atom->tag_extend();
+  atom->tag_check();
+
+  if (atom->map_style) {
+    atom->nghost = 0;
+    atom->map_init();
+    atom->map_set();
+  }
+
+  bigint ncreated = nblocal - nprevious, nall;
+  MPI_Allreduce(&ncreated,&nall,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  if (comm->me == 0) {
+    if (screen) fprintf(screen,"Created " BIGINT_FORMAT " biofilm atoms\n",nall);
+    if (logfile) fprintf(logfile,"Created " BIGINT_FORMAT " biofilm atoms\n",nall);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   type of a cell at height frac, chosen uniformly among the layers that
+   contain it; type 1 if no layer was given or none contains it
+------------------------------------------------------------------------- */
+
+int CreateBiofilm::pick_type(double frac, RanPark *random)
+{
+  int ncandidates = 0;
+  for (int l = 0; l < nlayers; l++)
+    if (frac >= llo[l] && frac <= lhi[l]) ncandidates++;
+  if (ncandidates == 0) return 1;
+
+  int pick = MIN((int) (random->uniform() * ncandidates), ncandidates - 1);
+  for (int l = 0; l < nlayers; l++) {
+    if (frac >= llo[l] && frac <= lhi[l]) {
+      if (pick == 0) return ltype[l];
+      pick--;
+    }
+  }
+  return 1;
+}
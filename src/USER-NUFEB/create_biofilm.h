@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifdef COMMAND_CLASS
+
+CommandStyle(create_biofilm,CreateBiofilm)
+
+#else
+
+#ifndef LMP_CREATE_BIOFILM_H
+#define LMP_CREATE_BIOFILM_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+class CreateBiofilm : protected Pointers {
+ public:
+  CreateBiofilm(class LAMMPS *);
+  ~CreateBiofilm();
+  void command(int, char **);
+
+ private:
+  int nlayers;
+  int *ltype;                      // type of each layer
+  double *llo, *lhi;               // bounds of each layer as fractions of the height
+
+  double dmin, dmax;               // range of diameters
+  double density;                  // cell density
+  double eps_ratio;                // largest outer over inner radius, 1 = no EPS shell
+  double eps_density;              // density of the EPS shell
+
+  int pick_type(double, class RanPark *);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal create_biofilm command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Create_biofilm command before simulation box is defined
+
+The create_biofilm command cannot be used before a read_data_bio,
+read_restart, or create_box command.
+
+E: Create_biofilm requires atom style bio
+
+Self-explanatory.
+
+E: Create_biofilm type name does not exist
+
+The type name must be defined in the Type Name section of the data file.
+
+E: Too many total atoms
+
+See the setting for bigint in the src/lmptype.h file.
+
+*/
@@ -13,6 +13,7 @@
 #define LMP_DECOMP_GRID_H
 
 #include "subgrid.h"
+#include "grid_partition.h"
 
 #include <vector>
 
@@ -25,6 +26,13 @@ namespace LAMMPS_NS {
 template <class Derived>
 class DecompGrid {
  public:
+  DecompGrid() : tree_stale(true), persistent_flag(false), shared_flag(false) {}
+  ~DecompGrid() { free_persistent(); }
+
+  // the decomposition may have changed outside of migrate(), e.g. by a
+  // balance command between runs; the next halo setup rebuilds the tree
+  void reset_tree() { tree_stale = true; }
+
   void setup_exchange(const Grid<double, 3> &grid,
 		      const Box<int, 3> &box,
 		      const std::array<bool, 3> &periodic) {
@@ -41,26 +49,26 @@ class DecompGrid {
 	  << ") [upper](" << box.upper[0] << ", " << box.upper[1] << ", " << box.upper[2] << ")" << std::endl;
 #endif
 
-    // communicate grid extent
-    std::vector<int> boxlo(3 * derived->comm->nprocs); 
-    MPI_Allgather(const_cast<int *>(&box.lower[0]), 3, MPI_INT, boxlo.data(), 3, MPI_INT, derived->world);
-    std::vector<int> boxhi(3 * derived->comm->nprocs);
-    MPI_Allgather(const_cast<int *>(&box.upper[0]), 3, MPI_INT, boxhi.data(), 3, MPI_INT, derived->world);
+    // find the ranks owning our halo and exchange grid extent with them only
+    std::vector<int> boxes;
+    find_neighbours(grid, box, periodic, boxes);
 
     clear();
-    recv_begin.resize(derived->comm->nprocs);
-    send_begin.resize(derived->comm->nprocs);
-    recv_end.resize(derived->comm->nprocs);
-    send_end.resize(derived->comm->nprocs);
-    requests.resize(2 * derived->comm->nprocs);
+    int nneighs = neighbours.size();
+    recv_begin.resize(nneighs);
+    send_begin.resize(nneighs);
+    recv_end.resize(nneighs);
+    send_end.resize(nneighs);
+    requests.resize(2 * nneighs);
     // look for intersetions
     Box<int, 3> ext_box = extend(box);
     Subgrid<double, 3> subgrid(grid, ext_box);
     int epc = derived->get_elem_per_cell();
-    for (int p = 0; p < derived->comm->nprocs; p++) {
-      recv_begin[p] = recv_cells.size() * epc;
-      send_begin[p] = send_cells.size() * epc;
-      Box<int, 3> other(&boxlo[3 * p], &boxhi[3 * p]);
+    for (int n = 0; n < nneighs; n++) {
+      int p = neighbours[n];
+      recv_begin[n] = recv_cells.size() * epc;
+      send_begin[n] = send_cells.size() * epc;
+      Box<int, 3> other(&boxes[6 * n], &boxes[6 * n + 3]);
       if (p != derived->comm->me) {
 #ifdef NUFEB_DEBUG_COMM
       debug << "Checking for intersections with proc " << p
@@ -89,11 +97,11 @@ class DecompGrid {
 	  setup_comm_cells(subgrid, box, translate(other, {0, 0, grid.get_dimensions()[2]}));
 	}
       }
-      recv_end[p] = recv_cells.size() * epc;
-      send_end[p] = send_cells.size() * epc;
+      recv_end[n] = recv_cells.size() * epc;
+      send_end[n] = send_cells.size() * epc;
     }
-    recv_buff.resize(recv_end.back());
-    send_buff.resize(send_end.back());
+    recv_buff.resize(recv_cells.size() * epc);
+    send_buff.resize(send_cells.size() * epc);
 
 #ifdef NUFEB_DEBUG_COMM
     debug << "<<< Leaving setup_exchange" << std::endl;
@@ -105,6 +113,22 @@ class DecompGrid {
     Derived *derived = static_cast<Derived *>(this);
     int epc = derived->get_elem_per_cell();
 
+#if MPI_VERSION >= 3
+    if (shared_flag) {
+      exchange_shared();
+      return;
+    }
+#endif
+
+    // halo cells are sent and received in place, see setup_persistent()
+    if (persistent_flag) {
+      if (!persistent_requests.empty()) {
+	MPI_Startall(persistent_requests.size(), persistent_requests.data());
+	MPI_Waitall(persistent_requests.size(), persistent_requests.data(), MPI_STATUSES_IGNORE);
+      }
+      return;
+    }
+
     // pack data to send buffer
     derived->pack_cells(send_cells.begin(), send_cells.end(), send_buff.begin());
 
@@ -133,14 +157,13 @@ class DecompGrid {
 
     // send and recv grid data
     int nrequests = 0;
-    for (int p = 0; p < derived->comm->nprocs; p++) {
-      if (p == derived->comm->me)
-	continue;
-      if (recv_begin[p] < recv_end[p]) {
-	MPI_Irecv(&recv_buff[recv_begin[p]], recv_end[p] - recv_begin[p], MPI_DOUBLE, p, 0, derived->world, &requests[nrequests++]);
+    for (size_t n = 0; n < neighbours.size(); n++) {
+      int p = neighbours[n];
+      if (recv_begin[n] < recv_end[n]) {
+	MPI_Irecv(&recv_buff[recv_begin[n]], recv_end[n] - recv_begin[n], MPI_DOUBLE, p, 0, derived->world, &requests[nrequests++]);
       }
-      if (send_begin[p] < send_end[p]) {
-	MPI_Isend(&send_buff[send_begin[p]], send_end[p] - send_begin[p], MPI_DOUBLE, p, 0, derived->world, &requests[nrequests++]);
+      if (send_begin[n] < send_end[n]) {
+	MPI_Isend(&send_buff[send_begin[n]], send_end[n] - send_begin[n], MPI_DOUBLE, p, 0, derived->world, &requests[nrequests++]);
       }
     }
     // wait for all MPI requests
@@ -180,70 +203,85 @@ class DecompGrid {
     // TODO: check if from_base contains from and to_base contains to
     Derived *derived = static_cast<Derived *>(this);
 
-    std::vector<Box<int, 3>> old_boxes(derived->comm->nprocs);
-    std::vector<Box<int, 3>> new_boxes(derived->comm->nprocs);
-
-    std::vector<int> old_boxlo(3 * derived->comm->nprocs); 
-    MPI_Allgather(const_cast<int *>(&from.lower[0]), 3, MPI_INT, old_boxlo.data(), 3, MPI_INT, derived->world);
-    std::vector<int> old_boxhi(3 * derived->comm->nprocs);
-    MPI_Allgather(const_cast<int *>(&from.upper[0]), 3, MPI_INT, old_boxhi.data(), 3, MPI_INT, derived->world);
-
-    std::vector<int> new_boxlo(3 * derived->comm->nprocs); 
-    MPI_Allgather(const_cast<int *>(&to.lower[0]), 3, MPI_INT, new_boxlo.data(), 3, MPI_INT, derived->world);
-    std::vector<int> new_boxhi(3 * derived->comm->nprocs);
-    MPI_Allgather(const_cast<int *>(&to.upper[0]), 3, MPI_INT, new_boxhi.data(), 3, MPI_INT, derived->world);
-
-    for (int p = 0; p < derived->comm->nprocs; p++) {
-      old_boxes[p] = Box<int, 3>(&old_boxlo[3 * p], &old_boxhi[3 * p]);
-      new_boxes[p] = Box<int, 3>(&new_boxlo[3 * p], &new_boxhi[3 * p]);
-    }
-    
+    int me = derived->comm->me;
+    int epc = derived->get_elem_per_cell();
+    const double *origin = grid.get_origin().data();
+    const double *h = grid.get_cell_size().data();
+
+    // ranks whose new box may overlap our old one, found from the current
+    // decomposition, plus the ranks whose old box may overlap our new one,
+    // which announce themselves
+    int msg[12];
+    std::copy(from.lower.begin(), from.lower.end(), msg);
+    std::copy(from.upper.begin(), from.upper.end(), msg + 3);
+    std::copy(to.lower.begin(), to.lower.end(), msg + 6);
+    std::copy(to.upper.begin(), to.upper.end(), msg + 9);
+    std::vector<int> targets;
+    // migrate() follows a rebalance, so the tree is rebuilt
+    tree_stale = true;
+    const GridRCBTree &tree = update_tree();
+    grid_owners(derived->comm, derived->get_partition(), tree, origin, h, from, targets);
+    targets.erase(std::remove(targets.begin(), targets.end(), me), targets.end());
+    std::vector<int> sources, data;
+    sparse_exchange(derived->world, targets, msg, 12, sources, data);
+    std::vector<int> procs(targets);
+    procs.insert(procs.end(), sources.begin(), sources.end());
+    std::sort(procs.begin(), procs.end());
+    procs.erase(std::unique(procs.begin(), procs.end()), procs.end());
+    std::vector<int> boxes;
+    neighbour_exchange(derived->world, procs, msg, 12, boxes);
+    // we are our own first partner
+    procs.insert(procs.begin(), me);
+    boxes.insert(boxes.begin(), msg, msg + 12);
+
+    int nprocs = procs.size();
     std::vector<int> mig_recv_cells;
     std::vector<int> mig_send_cells;
-    std::vector<int> mig_recv_begin(derived->comm->nprocs);
-    std::vector<int> mig_send_begin(derived->comm->nprocs);
-    std::vector<int> mig_recv_end(derived->comm->nprocs);
-    std::vector<int> mig_send_end(derived->comm->nprocs);
-    std::vector<MPI_Request> mig_requests(2 * derived->comm->nprocs);
+    std::vector<int> mig_recv_begin(nprocs);
+    std::vector<int> mig_send_begin(nprocs);
+    std::vector<int> mig_recv_end(nprocs);
+    std::vector<int> mig_send_end(nprocs);
+    std::vector<MPI_Request> mig_requests(2 * nprocs);
 
-    int me = derived->comm->me;
-    int epc = derived->get_elem_per_cell();
     Subgrid<double, 3> from_subgrid(grid, from_base);
     Subgrid<double, 3> to_subgrid(grid, to_base);
-    for (int p = 0; p < derived->comm->nprocs; p++) {
-      mig_recv_begin[p] = mig_recv_cells.size() * epc;
-      Box<int, 3> recv_box = intersect(new_boxes[me], old_boxes[p]);
+    for (int n = 0; n < nprocs; n++) {
+      Box<int, 3> old_box(&boxes[12 * n], &boxes[12 * n + 3]);
+      Box<int, 3> new_box(&boxes[12 * n + 6], &boxes[12 * n + 9]);
+      mig_recv_begin[n] = mig_recv_cells.size() * epc;
+      Box<int, 3> recv_box = intersect(to, old_box);
       if (!is_empty(recv_box)) {
 	add_cells(to_subgrid, recv_box, mig_recv_cells);
       }
-      mig_recv_end[p] = mig_recv_cells.size() * epc;
-      mig_send_begin[p] = mig_send_cells.size() * epc;
-      Box<int, 3> send_box = intersect(old_boxes[me], new_boxes[p]);
+      mig_recv_end[n] = mig_recv_cells.size() * epc;
+      mig_send_begin[n] = mig_send_cells.size() * epc;
+      Box<int, 3> send_box = intersect(from, new_box);
       if (!is_empty(send_box)) {
 	add_cells(from_subgrid, send_box, mig_send_cells);
       }
-      mig_send_end[p] = mig_send_cells.size() * epc;
+      mig_send_end[n] = mig_send_cells.size() * epc;
     }
 
-    std::vector<double> mig_send_buff(mig_send_end.back());
+    std::vector<double> mig_send_buff(mig_send_cells.size() * epc);
     derived->pack_cells(mig_send_cells.begin(), mig_send_cells.end(), mig_send_buff.begin());
 
     int nrequests = 0;
-    std::vector<double> mig_recv_buff(mig_recv_end.back());
-    for (int p = 0; p < derived->comm->nprocs; p++) {
-      if (p == derived->comm->me) {
-	if (mig_recv_begin[p] != mig_recv_end[p]) {
-	  std::copy(mig_send_buff.begin() + mig_send_begin[p],
-		    mig_send_buff.begin() + mig_send_end[p],
-		    mig_recv_buff.begin() + mig_recv_begin[p]);
+    std::vector<double> mig_recv_buff(mig_recv_cells.size() * epc);
+    for (int n = 0; n < nprocs; n++) {
+      int p = procs[n];
+      if (p == me) {
+	if (mig_recv_begin[n] != mig_recv_end[n]) {
+	  std::copy(mig_send_buff.begin() + mig_send_begin[n],
+		    mig_send_buff.begin() + mig_send_end[n],
+		    mig_recv_buff.begin() + mig_recv_begin[n]);
 	}
       }
       else {
-	if (mig_recv_begin[p] != mig_recv_end[p]) {
-	  MPI_Irecv(&mig_recv_buff[mig_recv_begin[p]], mig_recv_end[p] - mig_recv_begin[p], MPI_DOUBLE, p, 0, derived->world, &mig_requests[nrequests++]);
+	if (mig_recv_begin[n] != mig_recv_end[n]) {
+	  MPI_Irecv(&mig_recv_buff[mig_recv_begin[n]], mig_recv_end[n] - mig_recv_begin[n], MPI_DOUBLE, p, 0, derived->world, &mig_requests[nrequests++]);
 	}
-	if (mig_send_begin[p] != mig_send_end[p]) {
-	  MPI_Isend(&mig_send_buff[mig_send_begin[p]], mig_send_end[p] - mig_send_begin[p], MPI_DOUBLE, p, 0, derived->world, &mig_requests[nrequests++]);
+	if (mig_send_begin[n] != mig_send_end[n]) {
+	  MPI_Isend(&mig_send_buff[mig_send_begin[n]], mig_send_end[n] - mig_send_begin[n], MPI_DOUBLE, p, 0, derived->world, &mig_requests[nrequests++]);
 	}
       }
     }
@@ -252,7 +290,163 @@ class DecompGrid {
     derived->unpack_cells(mig_recv_cells.begin(), mig_recv_cells.end(), mig_recv_buff.begin());
   }
 
+  // replaces packing in exchange() by persistent requests on derived
+  // datatypes addressing the halo cells in place, where element e of a
+  // cell is array[e + 1][cell] and array is a memory->create() 2d array.
+  // must be called again after every setup_exchange()
+  void setup_persistent(double **array) {
+    Derived *derived = static_cast<Derived *>(this);
+    free_persistent();
+    int epc = derived->get_elem_per_cell();
+    if (epc < 1) return;
+    double *base = array[0];
+    int stride = array[1] - array[0];
+
+    std::vector<int> displs;
+    for (size_t n = 0; n < neighbours.size(); n++) {
+      for (int dir = 0; dir < 2; dir++) {
+	const std::vector<int> &cells = dir ? send_cells : recv_cells;
+	int begin = (dir ? send_begin[n] : recv_begin[n]) / epc;
+	int end = (dir ? send_end[n] : recv_end[n]) / epc;
+	if (begin == end)
+	  continue;
+	// same order as pack_cells(): all elements of a cell, then the next cell
+	displs.clear();
+	for (int c = begin; c < end; c++)
+	  for (int e = 1; e <= epc; e++)
+	    displs.push_back(e * stride + cells[c]);
+	MPI_Datatype type;
+	MPI_Type_create_indexed_block(displs.size(), 1, displs.data(), MPI_DOUBLE, &type);
+	MPI_Type_commit(&type);
+	persistent_types.push_back(type);
+	MPI_Request request;
+	if (dir)
+	  MPI_Send_init(base, 1, type, neighbours[n], 0, derived->world, &request);
+	else
+	  MPI_Recv_init(base, 1, type, neighbours[n], 0, derived->world, &request);
+	persistent_requests.push_back(request);
+      }
+    }
+    // the packing buffers are not needed anymore
+    std::vector<double>().swap(recv_buff);
+    std::vector<double>().swap(send_buff);
+    persistent_flag = true;
+  }
+
+#if MPI_VERSION >= 3
+  // copies halo cells owned by ranks of the same node directly out of
+  // their part of win, an MPI-3 shared window on node holding array as
+  // in setup_persistent(); other neighbours go through exchange() as usual.
+  // win must be in a lock_all epoch. must be called again after every
+  // setup_exchange()
+  void setup_shared(MPI_Comm node, MPI_Win win, double **array) {
+    Derived *derived = static_cast<Derived *>(this);
+    free_persistent();
+    int epc = derived->get_elem_per_cell();
+    int nneighs = neighbours.size();
+    shared_comm = node;
+    shared_win = win;
+    shared_array = array;
+
+    // node rank of each neighbour, MPI_UNDEFINED if on another node
+    MPI_Group world_group, node_group;
+    MPI_Comm_group(derived->world, &world_group);
+    MPI_Comm_group(node, &node_group);
+    node_ranks.resize(nneighs);
+    if (nneighs > 0)
+      MPI_Group_translate_ranks(world_group, nneighs, neighbours.data(), node_group, node_ranks.data());
+    MPI_Group_free(&world_group);
+    MPI_Group_free(&node_group);
+
+    // the sender's index of each cell we read, sent once by the sender
+    shared_cells.resize(recv_cells.size());
+    std::vector<MPI_Request> reqs;
+    for (int n = 0; n < nneighs; n++) {
+      if (node_ranks[n] == MPI_UNDEFINED)
+	continue;
+      int rbegin = recv_begin[n] / epc, rend = recv_end[n] / epc;
+      int sbegin = send_begin[n] / epc, send = send_end[n] / epc;
+      reqs.push_back(MPI_REQUEST_NULL);
+      MPI_Irecv(&shared_cells[rbegin], rend - rbegin, MPI_INT, neighbours[n], 0, derived->world, &reqs.back());
+      reqs.push_back(MPI_REQUEST_NULL);
+      MPI_Isend(&send_cells[sbegin], send - sbegin, MPI_INT, neighbours[n], 0, derived->world, &reqs.back());
+    }
+    if (!reqs.empty())
+      MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+
+    // base address and row length of the neighbours' arrays
+    shared_base.assign(nneighs, NULL);
+    shared_stride.assign(nneighs, 0);
+    for (int n = 0; n < nneighs; n++) {
+      if (node_ranks[n] == MPI_UNDEFINED)
+	continue;
+      MPI_Aint bytes;
+      int disp_unit;
+      MPI_Win_shared_query(win, node_ranks[n], &bytes, &disp_unit, &shared_base[n]);
+      shared_stride[n] = bytes / sizeof(double) / (epc + 1);
+    }
+    shared_flag = true;
+  }
+#endif
+
+  // # of doubles held in the halo exchange buffers
+  size_t buffer_size() const { return recv_buff.size() + send_buff.size(); }
+
  private:
+  // rebuilds the RCB tree of a tiled layout if the decomposition changed
+  // since the last call; collective, every caller of grid_owners() goes
+  // through it, so halo setups of the same decomposition reuse the tree
+  const GridRCBTree &update_tree() {
+    Derived *derived = static_cast<Derived *>(this);
+    if (tree_stale && derived->comm->layout == GRID_LAYOUT_TILED)
+      tree.setup(derived->comm, derived->world, derived->domain->boxlo, derived->domain->prd);
+    tree_stale = false;
+    return tree;
+  }
+
+  // sets neighbours to the ranks whose box may intersect our halo and
+  // returns their boxes, lower and upper, in boxes
+  void find_neighbours(const Grid<double, 3> &grid, const Box<int, 3> &box,
+		       const std::array<bool, 3> &periodic, std::vector<int> &boxes) {
+    Derived *derived = static_cast<Derived *>(this);
+    const double *origin = grid.get_origin().data();
+    const double *h = grid.get_cell_size().data();
+    const std::array<int, 3> &dims = grid.get_dimensions();
+
+    // only face neighbours share halo cells, see check_intersection()
+    std::vector<int> targets;
+    const GridRCBTree &tree = update_tree();
+    for (int d = 0; d < 3; d++) {
+      for (int side = 0; side < 2; side++) {
+	Box<int, 3> slab = box;
+	slab.lower[d] = side ? box.upper[d] : box.lower[d] - 1;
+	slab.upper[d] = slab.lower[d] + 1;
+	if (slab.lower[d] < 0 || slab.upper[d] > dims[d]) {
+	  if (!periodic[d])
+	    continue;
+	  std::array<int, 3> shift = {0, 0, 0};
+	  shift[d] = slab.lower[d] < 0 ? dims[d] : -dims[d];
+	  slab = translate(slab, shift);
+	}
+	grid_owners(derived->comm, derived->get_partition(), tree, origin, h, slab, targets);
+      }
+    }
+    int me = derived->comm->me;
+    targets.erase(std::remove(targets.begin(), targets.end(), me), targets.end());
+
+    int msg[6];
+    std::copy(box.lower.begin(), box.lower.end(), msg);
+    std::copy(box.upper.begin(), box.upper.end(), msg + 3);
+    std::vector<int> sources, data;
+    sparse_exchange(derived->world, targets, msg, 6, sources, data);
+
+    neighbours = targets;
+    neighbours.insert(neighbours.end(), sources.begin(), sources.end());
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    neighbour_exchange(derived->world, neighbours, msg, 6, boxes);
+  }
+
   void add_cells(const Subgrid<double, 3> &subgrid, const Box<int, 3> &box, std::vector<int> &cells)
   {
     for (int k = box.lower[2]; k < box.upper[2]; k++) {
@@ -292,7 +486,6 @@ class DecompGrid {
   void setup_comm_cells(const Subgrid<double, 3> &subgrid, const Box<int, 3> &box, const Box<int, 3> &other) {
     // identify which cells we need to recv
     Box<int, 3> recvbox = intersect(extend(box), other);
-    int n = cell_count(recvbox);
     if (check_intersection(recvbox)) {
 #ifdef NUFEB_DEBUG_COMM
       debug << "Receiving cells from proc: ";
@@ -304,7 +497,6 @@ class DecompGrid {
     }
     // identify which cells we need to send
     Box<int, 3> sendbox = intersect(extend(other), box);
-    n = cell_count(sendbox);
     if (check_intersection(sendbox)) {
 #ifdef NUFEB_DEBUG_COMM
       debug << "Sending cells from proc: ";
@@ -316,7 +508,71 @@ class DecompGrid {
     }
   }
 
+#if MPI_VERSION >= 3
+  void exchange_shared() {
+    Derived *derived = static_cast<Derived *>(this);
+    int epc = derived->get_elem_per_cell();
+    int nneighs = neighbours.size();
+
+    // off-node neighbours, packed per neighbour
+    int nrequests = 0;
+    for (int n = 0; n < nneighs; n++) {
+      if (node_ranks[n] != MPI_UNDEFINED)
+	continue;
+      int p = neighbours[n];
+      if (recv_begin[n] < recv_end[n]) {
+	MPI_Irecv(&recv_buff[recv_begin[n]], recv_end[n] - recv_begin[n], MPI_DOUBLE, p, 0, derived->world, &requests[nrequests++]);
+      }
+      if (send_begin[n] < send_end[n]) {
+	derived->pack_cells(send_cells.begin() + send_begin[n] / epc, send_cells.begin() + send_end[n] / epc,
+			    send_buff.begin() + send_begin[n]);
+	MPI_Isend(&send_buff[send_begin[n]], send_end[n] - send_begin[n], MPI_DOUBLE, p, 0, derived->world, &requests[nrequests++]);
+      }
+    }
+
+    // on-node neighbours, read in place once everybody has its interior ready
+    // and wait for all reads to finish before anybody writes to it again
+    MPI_Win_sync(shared_win);
+    MPI_Barrier(shared_comm);
+    for (int n = 0; n < nneighs; n++) {
+      if (node_ranks[n] == MPI_UNDEFINED)
+	continue;
+      const double *base = shared_base[n];
+      int stride = shared_stride[n];
+      for (int c = recv_begin[n] / epc; c < recv_end[n] / epc; c++) {
+	int cell = recv_cells[c];
+	int remote = shared_cells[c];
+	for (int e = 1; e <= epc; e++)
+	  shared_array[e][cell] = base[e * stride + remote];
+      }
+    }
+    MPI_Win_sync(shared_win);
+    MPI_Barrier(shared_comm);
+
+    if (nrequests > 0)
+      MPI_Waitall(nrequests, requests.data(), MPI_STATUSES_IGNORE);
+    for (int n = 0; n < nneighs; n++) {
+      if (node_ranks[n] != MPI_UNDEFINED || recv_begin[n] == recv_end[n])
+	continue;
+      derived->unpack_cells(recv_cells.begin() + recv_begin[n] / epc, recv_cells.begin() + recv_end[n] / epc,
+			    recv_buff.begin() + recv_begin[n]);
+    }
+  }
+#endif
+
+  void free_persistent() {
+    for (size_t i = 0; i < persistent_requests.size(); i++)
+      MPI_Request_free(&persistent_requests[i]);
+    for (size_t i = 0; i < persistent_types.size(); i++)
+      MPI_Type_free(&persistent_types[i]);
+    persistent_requests.clear();
+    persistent_types.clear();
+    persistent_flag = false;
+  }
+
   void clear() {
+    free_persistent();
+    shared_flag = false;
     recv_cells.clear();
     send_cells.clear();
     recv_begin.clear();
@@ -328,6 +584,9 @@ class DecompGrid {
     requests.clear();
   }
 
+  GridRCBTree tree;                 // RCB tree of the last update_tree()
+  bool tree_stale;                  // true if tree may not match the decomposition
+  std::vector<int> neighbours;      // ranks we exchange halo cells with
   std::vector<int> recv_cells;
   std::vector<int> send_cells;
   std::vector<int> recv_begin;
@@ -337,6 +596,17 @@ class DecompGrid {
   std::vector<double> recv_buff;
   std::vector<double> send_buff;
   std::vector<MPI_Request> requests;
+  bool persistent_flag;             // true if exchange() uses the persistent requests
+  std::vector<MPI_Request> persistent_requests;
+  std::vector<MPI_Datatype> persistent_types;
+  bool shared_flag;                 // true if exchange() reads on-node halos from shared_win
+  MPI_Comm shared_comm;
+  MPI_Win shared_win;
+  double **shared_array;
+  std::vector<int> node_ranks;      // rank of each neighbour in shared_comm
+  std::vector<int> shared_cells;    // sender's index of each recv cell
+  std::vector<double *> shared_base;
+  std::vector<int> shared_stride;
 
 #ifdef NUFEB_DEBUG_COMM
   std::ofstream debug;
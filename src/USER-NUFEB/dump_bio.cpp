@@ -30,6 +30,7 @@
 #include "modify.h"
 #include "atom.h"
 #include "bio.h"
+#include "bio_timer.h"
 #include "fix_bio_kinetics.h"
 
 #include "compute_bio_diameter.h"
@@ -320,6 +321,8 @@ void DumpBio::write()
 {
   if (update-> ntimestep == 0) return;
 
+  kinetics->bio->timer->start(BioTimer::OUTPUT);
+
   if (ntypes_flag == 1) ctype->compute_vector();
   if (mass_flag == 1) cmass->compute_vector();
   if (dia_flag == 1)  cdia->compute_scalar();
@@ -485,6 +488,8 @@ void DumpBio::write()
       }
     }
 }
+
+  kinetics->bio->timer->stop(BioTimer::OUTPUT);
 }
 
 /* ---------------------------------------------------------------------- */
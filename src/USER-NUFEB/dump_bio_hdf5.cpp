@@ -14,6 +14,7 @@
 
 #include "atom_vec_bio.h"
 #include "bio.h"
+#include "bio_timer.h"
 #include "fix_bio_kinetics.h"
 #include "fix_bio_kinetics_energy.h"
 
@@ -71,6 +72,8 @@ hid_t DumpBioHDF5::create_filespace_grid(bool oneperproc) {
 }
 
 void DumpBioHDF5::write() {
+  bio->timer->start(BioTimer::OUTPUT);
+
   std::string str(filename);
   auto perc = str.find('%');
   bool oneperproc = false; // one file per proc?
@@ -168,6 +171,8 @@ void DumpBioHDF5::write() {
     }
   }
   H5Fclose(file);
+
+  bio->timer->stop(BioTimer::OUTPUT);
 }
 
 int DumpBioHDF5::parse_fields(int narg, char **arg) {
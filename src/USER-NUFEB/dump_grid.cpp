@@ -14,6 +14,7 @@
 
 #include "atom_vec_bio.h"
 #include "bio.h"
+#include "bio_timer.h"
 #include "fix_bio_kinetics.h"
 #include "fix_bio_kinetics_energy.h"
 
@@ -97,6 +98,8 @@ void DumpGrid::init_style() {
 }
 
 void DumpGrid::write() {
+  bio->timer->start(BioTimer::OUTPUT);
+
   vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
   std::array<int, 3> dim = kinetics->subgrid.get_dimensions();
   image->SetDimensions(dim[0] + 1, dim[1] + 1, dim[2] + 1);
@@ -127,6 +130,8 @@ void DumpGrid::write() {
   writer->SetFileName(str.c_str());
   writer->SetInputData(image);
   writer->Write();
+
+  bio->timer->stop(BioTimer::OUTPUT);
 }
 
 int DumpGrid::parse_fields(int narg, char **arg) {
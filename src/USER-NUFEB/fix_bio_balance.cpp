@@ -269,6 +269,19 @@ inline double trim(double split, int n)
   return (double)i / n;
 }
 
+// round the inner cuts of nslabs slabs to the nearest grid plane, keeping
+// them strictly increasing so every slab holds at least one plane
+inline void snap_cuts(double *split, int nslabs, int n)
+{
+  int prev = 0;
+  for (int m = 1; m < nslabs; m++) {
+    int cut = split[m] * n + 0.5;
+    if (n >= nslabs) cut = MIN(MAX(cut, prev + 1), n - (nslabs - m));
+    split[m] = (double)cut / n;
+    prev = cut;
+  }
+}
+
 void FixKineticsBalance::rebalance()
 {
   imbprev = imbnow;
@@ -279,15 +292,10 @@ void FixKineticsBalance::rebalance()
   if (lbstyle == SHIFT) {
     itercount = balance->shift();
     comm->layout = LAYOUT_NONUNIFORM;
-    for (int i = 0; i < comm->procgrid[0]; i++) {
-      comm->xsplit[i] = trim(i * 1.0 / comm->procgrid[0], kinetics->nx);
-    }
-    for (int i = 0; i < comm->procgrid[1]; i++) {
-      comm->ysplit[i] = trim(i * 1.0 / comm->procgrid[1], kinetics->ny);
-    }
-    for (int i = 0; i < comm->procgrid[2]; i++) {
-      comm->zsplit[i] = trim(i * 1.0 / comm->procgrid[2], kinetics->nz);
-    }
+    // align the shifted cuts to the grid
+    snap_cuts(comm->xsplit, comm->procgrid[0], kinetics->nx);
+    snap_cuts(comm->ysplit, comm->procgrid[1], kinetics->ny);
+    snap_cuts(comm->zsplit, comm->procgrid[2], kinetics->nz);
   } else if (lbstyle == BISECTION) {
     sendproc = balance->bisection();
     comm->layout = LAYOUT_TILED;
@@ -0,0 +1,562 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include "fix_bio_balance_cost.h"
+#include "fix_bio_kinetics.h"
+#include "bio.h"
+#include "bio_timer.h"
+#include "update.h"
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "neighbor.h"
+#include "irregular.h"
+#include "force.h"
+#include "modify.h"
+#include "rcb.h"
+#include "timer.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+enum{SHIFT,BISECTION,BLAYER};
+enum{LAYOUT_UNIFORM,LAYOUT_NONUNIFORM,LAYOUT_TILED};    // several files
+
+#define DELTA 10000
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsBalanceCost::FixKineticsBalanceCost(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg), rcb(NULL), irregular(NULL)
+{
+  if (narg < 6) error->all(FLERR,"Illegal fix kinetics/balance/cost command");
+
+  box_change_domain = 1;
+  scalar_flag = 1;
+  extscalar = 0;
+  vector_flag = 1;
+  size_vector = 5;
+  extvector = 0;
+  global_freq = 1;
+
+  nevery = force->inumeric(FLERR,arg[3]);
+  if (nevery < 0) error->all(FLERR,"Illegal fix kinetics/balance/cost command");
+  thresh = force->numeric(FLERR,arg[4]);
+
+  int iarg;
+  if (strcmp(arg[5],"shift") == 0) {
+    lbstyle = SHIFT;
+    if (narg < 7 || strlen(arg[6]) > 3)
+      error->all(FLERR,"Illegal fix kinetics/balance/cost command");
+    strcpy(bstr,arg[6]);
+    iarg = 7;
+  } else if (strcmp(arg[5],"rcb") == 0) {
+    lbstyle = BISECTION;
+    iarg = 6;
+  } else if (strcmp(arg[5],"blayer") == 0) {
+    lbstyle = BLAYER;
+    if (narg < 7) error->all(FLERR,"Illegal fix kinetics/balance/cost command");
+    margin = force->inumeric(FLERR,arg[6]);
+    if (margin < 0) error->all(FLERR,"Illegal fix kinetics/balance/cost command");
+    iarg = 7;
+  } else error->all(FLERR,"Illegal fix kinetics/balance/cost command");
+
+  costflag = 1;
+  cgrid = cdem = 1.0;
+
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"cost") == 0) {
+      if (iarg+3 > narg) error->all(FLERR,"Illegal fix kinetics/balance/cost command");
+      costflag = 0;
+      cgrid = force->numeric(FLERR,arg[iarg+1]);
+      cdem = force->numeric(FLERR,arg[iarg+2]);
+      if (cgrid < 0.0 || cdem < 0.0)
+        error->all(FLERR,"Illegal fix kinetics/balance/cost command");
+      iarg += 3;
+    } else error->all(FLERR,"Illegal fix kinetics/balance/cost command");
+  }
+
+  // error checks
+
+  if (lbstyle == SHIFT) {
+    int blen = strlen(bstr);
+    for (int i = 0; i < blen; i++) {
+      if (bstr[i] != 'x' && bstr[i] != 'y' && bstr[i] != 'z')
+        error->all(FLERR,"Fix kinetics/balance/cost shift string is invalid");
+      if (bstr[i] == 'z' && domain->dimension == 2)
+        error->all(FLERR,"Fix kinetics/balance/cost shift string is invalid");
+      for (int j = i+1; j < blen; j++)
+        if (bstr[i] == bstr[j])
+          error->all(FLERR,"Fix kinetics/balance/cost shift string is invalid");
+    }
+  }
+
+  if (lbstyle == BISECTION && comm->style == 0)
+    error->all(FLERR,"Fix kinetics/balance/cost rcb cannot be used with comm_style brick");
+  if (lbstyle == BLAYER && comm->style != 0)
+    error->all(FLERR,"Fix kinetics/balance/cost blayer requires comm_style brick");
+  if (lbstyle == BLAYER && domain->dimension == 2)
+    error->all(FLERR,"Fix kinetics/balance/cost blayer requires a 3d domain");
+
+  if (lbstyle == BISECTION) rcb = new RCB(lmp);
+  irregular = new Irregular(lmp);
+
+  if (nevery) force_reneighbor = 1;
+  lastbalance = -1;
+
+  imbnow = imbpred = imbachieved = 0.0;
+  kin_prev = dem_prev = 0.0;
+  pending = 0;
+
+  ndots = maxdots = maxatom = 0;
+  dotx = NULL;
+  dotw = NULL;
+  atom_dot = NULL;
+  sendproc = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsBalanceCost::~FixKineticsBalanceCost()
+{
+  delete rcb;
+  delete irregular;
+
+  memory->destroy(dotx);
+  memory->destroy(dotw);
+  memory->destroy(atom_dot);
+  memory->destroy(sendproc);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixKineticsBalanceCost::setmask()
+{
+  int mask = 0;
+  mask |= PRE_EXCHANGE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsBalanceCost::init()
+{
+  kinetics = NULL;
+  int nfix = modify->nfix;
+  for (int j = 0; j < nfix; j++) {
+    if (strcmp(modify->fix[j]->style,"kinetics") == 0) {
+      kinetics = static_cast<FixKinetics *>(lmp->modify->fix[j]);
+      break;
+    }
+  }
+
+  if (kinetics == NULL)
+    error->all(FLERR,"Fix kinetics/balance/cost requires fix kinetics");
+
+  // both the NUFEB and the LAMMPS timers restart with each run
+
+  kin_prev = dem_prev = 0.0;
+  pending = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsBalanceCost::setup_pre_exchange()
+{
+  if (update->ntimestep == lastbalance) return;
+  lastbalance = update->ntimestep;
+
+  check();
+
+  if (nevery) next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsBalanceCost::pre_exchange()
+{
+  if (nevery && update->ntimestep < next_reneighbor) return;
+
+  if (update->ntimestep == lastbalance) return;
+  lastbalance = update->ntimestep;
+
+  check();
+
+  if (nevery) next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
+}
+
+/* ----------------------------------------------------------------------
+   update the costs and rebalance if the modelled imbalance is too large
+------------------------------------------------------------------------- */
+
+void FixKineticsBalanceCost::check()
+{
+  // insure atoms are in current box before they are assigned to cells
+
+  if (domain->triclinic) domain->x2lamda(atom->nlocal);
+  domain->pbc();
+  domain->reset_box();
+  if (domain->triclinic) domain->lamda2x(atom->nlocal);
+
+  measure();
+
+  if (pending && comm->me == 0) {
+    if (screen)
+      fprintf(screen,"kinetics/balance/cost: predicted imbalance %g, "
+              "achieved %g\n",imbpred,imbachieved);
+    if (logfile)
+      fprintf(logfile,"kinetics/balance/cost: predicted imbalance %g, "
+              "achieved %g\n",imbpred,imbachieved);
+  }
+  pending = 0;
+
+  imbnow = model_imbalance();
+  if (imbnow > thresh || (lbstyle == BLAYER && blayer_moved())) rebalance();
+}
+
+/* ----------------------------------------------------------------------
+   top of the z range shared by all but the top layer of procs, the
+   active grid planes plus margin, leaving at least one plane on top
+------------------------------------------------------------------------- */
+
+int FixKineticsBalanceCost::blayer_top()
+{
+  int nz = kinetics->nz;
+  int top = MAX(comm->procgrid[2] - 1, kinetics->bnz + margin);
+  return MIN(top, nz - 1);
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if the boundary layer has left the lower layers of procs
+------------------------------------------------------------------------- */
+
+int FixKineticsBalanceCost::blayer_moved()
+{
+  int pz = comm->procgrid[2];
+  if (pz == 1) return 0;
+  int nz = kinetics->nz;
+  int top = static_cast<int>(comm->zsplit[pz - 1] * nz + 0.5);
+  return comm->layout == LAYOUT_UNIFORM || top != blayer_top();
+}
+
+/* ----------------------------------------------------------------------
+   measure the kinetics time per active grid cell and the DEM time per
+   particle since the last check, and the imbalance of their sum
+------------------------------------------------------------------------- */
+
+void FixKineticsBalanceCost::measure()
+{
+  BioTimer *t = kinetics->bio->timer;
+  double kin = t->get(BioTimer::REACTION) + t->get(BioTimer::DIFFUSION) +
+    t->get(BioTimer::GROWTH);
+  double dem = timer->get_wall(Timer::PAIR) + timer->get_wall(Timer::NEIGH);
+
+  double local[4], global[4];
+  local[0] = kin - kin_prev;
+  local[1] = dem - dem_prev;
+  local[2] = kinetics->bgrids;
+  local[3] = atom->nlocal;
+  kin_prev = kin;
+  dem_prev = dem;
+  MPI_Allreduce(local,global,4,MPI_DOUBLE,MPI_SUM,world);
+
+  double busy = local[0] + local[1];
+  double maxbusy;
+  MPI_Allreduce(&busy,&maxbusy,1,MPI_DOUBLE,MPI_MAX,world);
+
+  double avgbusy = (global[0] + global[1]) / comm->nprocs;
+  imbachieved = avgbusy > 0.0 ? maxbusy / avgbusy : 1.0;
+
+  if (costflag) {
+    if (global[0] > 0.0 && global[2] > 0.0) cgrid = global[0] / global[2];
+    if (global[1] > 0.0 && global[3] > 0.0) cdem = global[1] / global[3];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   imbalance factor of the current decomposition under the cost model
+------------------------------------------------------------------------- */
+
+double FixKineticsBalanceCost::model_imbalance()
+{
+  double cost = cgrid * kinetics->bgrids + cdem * atom->nlocal;
+  double maxcost,sumcost;
+  MPI_Allreduce(&cost,&maxcost,1,MPI_DOUBLE,MPI_MAX,world);
+  MPI_Allreduce(&cost,&sumcost,1,MPI_DOUBLE,MPI_SUM,world);
+  if (sumcost == 0.0) return 1.0;
+  return maxcost / (sumcost / comm->nprocs);
+}
+
+/* ----------------------------------------------------------------------
+   one weighted dot at the centre of each local grid cell holding work,
+   active cells below the boundary layer weigh cgrid and each particle
+   adds cdem to the dot of its cell
+   particles outside of the local grid get a dot of their own
+------------------------------------------------------------------------- */
+
+void FixKineticsBalanceCost::build_dots()
+{
+  int nlocal = atom->nlocal;
+  if (nlocal > maxatom) {
+    maxatom = atom->nmax;
+    memory->destroy(atom_dot);
+    memory->destroy(sendproc);
+    memory->create(atom_dot,maxatom,"kinetics/balance/cost:atom_dot");
+    memory->create(sendproc,maxatom,"kinetics/balance/cost:sendproc");
+  }
+
+  int *subn = kinetics->subn;
+  int *subnlo = kinetics->subnlo;
+  int ngrids = subn[0] * subn[1] * subn[2];
+  std::vector<int> cell_dot(ngrids,-1);
+  int n[3] = {kinetics->nx, kinetics->ny, kinetics->nz};
+  double **x = atom->x;
+
+  ndots = 0;
+  for (int i = 0; i < nlocal; i++) {
+    // atoms have not migrated yet, so the cell is clamped to the grid and
+    // checked against the local grid as in FixKinetics::bin_atoms()
+    int cell[3];
+    bool inside = true;
+    for (int d = 0; d < 3; d++) {
+      cell[d] = static_cast<int>((x[i][d] - domain->boxlo[d]) / domain->prd[d] * n[d]);
+      cell[d] = MAX(0,MIN(n[d]-1,cell[d]));
+      inside = inside && cell[d] >= subnlo[d] && cell[d] < subnlo[d] + subn[d];
+    }
+    if (inside) {
+      int g = (cell[0] - subnlo[0]) + (cell[1] - subnlo[1]) * subn[0] +
+        (cell[2] - subnlo[2]) * subn[0] * subn[1];
+      if (cell_dot[g] < 0) {
+        cell_dot[g] = ndots;
+        add_dot(cell,0.0);
+      }
+      atom_dot[i] = cell_dot[g];
+      dotw[atom_dot[i]] += cdem;
+    } else {
+      atom_dot[i] = ndots;
+      add_dot(cell,cdem);
+    }
+  }
+
+  int nactive = subn[0] * subn[1] * MIN(subn[2],MAX(0,kinetics->bnz - subnlo[2]));
+  for (int g = 0; g < nactive; g++) {
+    if (cell_dot[g] < 0) {
+      int cell[3];
+      cell[0] = subnlo[0] + g % subn[0];
+      cell[1] = subnlo[1] + (g / subn[0]) % subn[1];
+      cell[2] = subnlo[2] + g / (subn[0] * subn[1]);
+      cell_dot[g] = ndots;
+      add_dot(cell,0.0);
+    }
+    dotw[cell_dot[g]] += cgrid;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsBalanceCost::add_dot(const int *cell, double w)
+{
+  if (ndots == maxdots) {
+    maxdots += DELTA;
+    memory->grow(dotx,maxdots,3,"kinetics/balance/cost:dotx");
+    memory->grow(dotw,maxdots,"kinetics/balance/cost:dotw");
+  }
+  int n[3] = {kinetics->nx, kinetics->ny, kinetics->nz};
+  for (int d = 0; d < 3; d++)
+    dotx[ndots][d] = domain->boxlo[d] + (cell[d] + 0.5) * domain->prd[d] / n[d];
+  dotw[ndots] = w;
+  ndots++;
+}
+
+/* ----------------------------------------------------------------------
+   place the cuts m0 < m < m1 of dimension d, which split grid planes
+   [c0, c1), on the planes closest to an equal share of the cost
+   projected on that dimension
+------------------------------------------------------------------------- */
+
+void FixKineticsBalanceCost::shift_cuts(int d, int c0, int c1, int m0, int m1)
+{
+  int n = d == 0 ? kinetics->nx : (d == 1 ? kinetics->ny : kinetics->nz);
+  double *split = d == 0 ? comm->xsplit : (d == 1 ? comm->ysplit : comm->zsplit);
+  int nslabs = m1 - m0;
+  int nplanes = c1 - c0;
+
+  std::vector<double> local(n,0.0), profile(n);
+  for (int j = 0; j < ndots; j++) {
+    int c = static_cast<int>((dotx[j][d] - domain->boxlo[d]) / domain->prd[d] * n);
+    local[MAX(0,MIN(n-1,c))] += dotw[j];
+  }
+  MPI_Allreduce(local.data(),profile.data(),n,MPI_DOUBLE,MPI_SUM,world);
+
+  double total = 0.0;
+  for (int c = c0; c < c1; c++) total += profile[c];
+
+  split[m0] = (double) c0 / n;
+  split[m1] = (double) c1 / n;
+  double sum = 0.0;
+  int c = c0;
+  int prev = c0;
+  for (int m = 1; m < nslabs; m++) {
+    double target = total * m / nslabs;
+    while (c < c1 && sum + 0.5 * profile[c] < target) sum += profile[c++];
+    // keep at least one grid plane per slab when possible
+    int cut = c;
+    if (nplanes >= nslabs) cut = MIN(MAX(cut,prev + 1),c1 - (nslabs - m));
+    split[m0 + m] = (double) cut / n;
+    prev = cut;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   snap a fractional position to the closest grid plane
+------------------------------------------------------------------------- */
+
+static inline double snap(double frac, int n)
+{
+  return floor(frac * n + 0.5) / n;
+}
+
+/* ----------------------------------------------------------------------
+   perform dynamic load balancing
+------------------------------------------------------------------------- */
+
+void FixKineticsBalanceCost::rebalance()
+{
+  build_dots();
+
+  int nprocs = comm->nprocs;
+  std::vector<double> loads(nprocs,0.0);
+  int n[3] = {kinetics->nx, kinetics->ny, kinetics->nz};
+  double *boxlo = domain->boxlo;
+  double *prd = domain->prd;
+
+  if (lbstyle == SHIFT) {
+    comm->layout = LAYOUT_NONUNIFORM;
+    int blen = strlen(bstr);
+    for (int i = 0; i < blen; i++) {
+      int d = bstr[i] - 'x';
+      shift_cuts(d,0,n[d],0,comm->procgrid[d]);
+    }
+    int igx,igy,igz;
+    for (int j = 0; j < ndots; j++)
+      loads[comm->coord2proc(dotx[j],igx,igy,igz)] += dotw[j];
+  } else if (lbstyle == BLAYER) {
+    // all but the top layer of procs share the active planes by cost,
+    // the top layer holds the inactive grid and bulk above
+    comm->layout = LAYOUT_NONUNIFORM;
+    int pz = comm->procgrid[2];
+    shift_cuts(0,0,n[0],0,comm->procgrid[0]);
+    shift_cuts(1,0,n[1],0,comm->procgrid[1]);
+    if (pz > 1) {
+      shift_cuts(2,0,blayer_top(),0,pz - 1);
+      comm->zsplit[pz] = 1.0;
+    }
+    int igx,igy,igz;
+    for (int j = 0; j < ndots; j++)
+      loads[comm->coord2proc(dotx[j],igx,igy,igz)] += dotw[j];
+  } else {
+    // dots sit at cell centres, so every RCB cut falls on a grid plane
+    // and snapping it only removes round-off
+    rcb->compute(domain->dimension,ndots,dotx,dotw,boxlo,domain->boxhi);
+    rcb->invert();
+    comm->layout = LAYOUT_TILED;
+    comm->rcbnew = 1;
+    int idim = rcb->cutdim;
+    comm->rcbcutdim = idim;
+    if (idim >= 0) comm->rcbcutfrac = snap((rcb->cut - boxlo[idim]) / prd[idim],n[idim]);
+    else comm->rcbcutfrac = 0.0;
+    double (*mysplit)[2] = comm->mysplit;
+    for (int d = 0; d < 3; d++) {
+      mysplit[d][0] = snap((rcb->lo[d] - boxlo[d]) / prd[d],n[d]);
+      mysplit[d][1] = snap((rcb->hi[d] - boxlo[d]) / prd[d],n[d]);
+    }
+    for (int j = 0; j < ndots; j++)
+      loads[rcb->sendproc[j]] += dotw[j];
+    for (int i = 0; i < atom->nlocal; i++)
+      sendproc[i] = rcb->sendproc[atom_dot[i]];
+  }
+
+  // predicted imbalance factor of the new decomposition
+
+  std::vector<int> counts(nprocs,1);
+  double mycost,maxcost,sumcost;
+  MPI_Reduce_scatter(loads.data(),&mycost,counts.data(),MPI_DOUBLE,MPI_SUM,world);
+  MPI_Allreduce(&mycost,&maxcost,1,MPI_DOUBLE,MPI_MAX,world);
+  MPI_Allreduce(&mycost,&sumcost,1,MPI_DOUBLE,MPI_SUM,world);
+  imbpred = sumcost > 0.0 ? maxcost / (sumcost / nprocs) : 1.0;
+
+  // reset proc sub-domains and move atoms and grid
+
+  if (domain->triclinic) domain->set_lamda_box();
+  domain->set_local_box();
+  domain->subbox_too_small_check(neighbor->skin);
+
+  if (domain->triclinic) domain->x2lamda(atom->nlocal);
+  if (lbstyle == BISECTION) irregular->migrate_atoms(0,1,sendproc);
+  else if (irregular->migrate_check()) irregular->migrate_atoms();
+  if (domain->triclinic) domain->lamda2x(atom->nlocal);
+
+  kinetics->migrate();
+
+  if (comm->me == 0) {
+    if (screen)
+      fprintf(screen,"kinetics/balance/cost: step " BIGINT_FORMAT
+              " imbalance %g, predicted %g, cgrid %g cdem %g\n",
+              update->ntimestep,imbnow,imbpred,cgrid,cdem);
+    if (logfile)
+      fprintf(logfile,"kinetics/balance/cost: step " BIGINT_FORMAT
+              " imbalance %g, predicted %g, cgrid %g cdem %g\n",
+              update->ntimestep,imbnow,imbpred,cgrid,cdem);
+  }
+  pending = 1;
+}
+
+/* ----------------------------------------------------------------------
+   return predicted imbalance factor after last rebalance
+------------------------------------------------------------------------- */
+
+double FixKineticsBalanceCost::compute_scalar()
+{
+  return imbpred;
+}
+
+/* ----------------------------------------------------------------------
+   return imbalance before and after last rebalance, measured imbalance
+   over the last interval and the costs of a grid cell and a particle
+------------------------------------------------------------------------- */
+
+double FixKineticsBalanceCost::compute_vector(int i)
+{
+  if (i == 0) return imbnow;
+  if (i == 1) return imbpred;
+  if (i == 2) return imbachieved;
+  if (i == 3) return cgrid;
+  return cdem;
+}
+
+/* ----------------------------------------------------------------------
+   return # of bytes of allocated memory
+------------------------------------------------------------------------- */
+
+double FixKineticsBalanceCost::memory_usage()
+{
+  double bytes = irregular->memory_usage();
+  if (rcb) bytes += rcb->memory_usage();
+  bytes += maxdots * 4 * sizeof(double);
+  bytes += maxatom * 2 * sizeof(int);
+  return bytes;
+}
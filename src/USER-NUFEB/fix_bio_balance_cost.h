@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(kinetics/balance/cost,FixKineticsBalanceCost)
+
+#else
+
+#ifndef SRC_FIX_KINETICS_BALANCE_COST_H
+#define SRC_FIX_KINETICS_BALANCE_COST_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixKineticsBalanceCost : public Fix {
+ public:
+  FixKineticsBalanceCost(class LAMMPS *, int, char **);
+  ~FixKineticsBalanceCost();
+  int setmask();
+  void init();
+  void setup_pre_exchange();
+  void pre_exchange();
+  double compute_scalar();
+  double compute_vector(int);
+  double memory_usage();
+
+ private:
+  int nevery,lbstyle;
+  double thresh;
+  char bstr[4];
+  int margin;                   // # of grid planes above bnz kept in the lower layers with blayer
+  int costflag;                 // 1 = measure cgrid and cdem, 0 = use the given values
+  double cgrid;                 // cost of an active grid cell
+  double cdem;                  // cost of a particle
+
+  double imbnow;                // modelled imbalance factor before the last rebalancing
+  double imbpred;               // modelled imbalance factor after the last rebalancing
+  double imbachieved;           // measured imbalance factor over the last interval
+  double kin_prev, dem_prev;    // timers at the last check
+  bigint lastbalance;           // last timestep balancing was attempted
+  int pending;                  // 1 = report the achieved imbalance at the next check
+
+  int ndots,maxdots;            // cost dots at grid cell centres
+  double **dotx;                // dot coordinates [dot][3]
+  double *dotw;                 // dot cost [dot]
+  int *atom_dot;                // dot of each local atom [nlocal]
+  int *sendproc;                // new proc of each local atom with rcb [nlocal]
+  int maxatom;
+
+  class FixKinetics *kinetics;
+  class RCB *rcb;
+  class Irregular *irregular;
+
+  void check();
+  void measure();
+  double model_imbalance();
+  void build_dots();
+  void add_dot(const int *, double);
+  void shift_cuts(int, int, int, int, int);
+  int blayer_top();
+  int blayer_moved();
+  void rebalance();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Fix kinetics/balance/cost shift string is invalid
+
+The string can only contain the characters "x", "y", or "z".
+
+E: Fix kinetics/balance/cost rcb cannot be used with comm_style brick
+
+Use comm_style tiled with rcb.
+
+E: Fix kinetics/balance/cost blayer requires comm_style brick
+
+The boundary layer style moves the z cuts of a processor grid.
+
+E: Fix kinetics/balance/cost blayer requires a 3d domain
+
+Self-explanatory.
+
+E: Fix kinetics/balance/cost requires fix kinetics
+
+The cost model needs the kinetics grid.
+
+*/
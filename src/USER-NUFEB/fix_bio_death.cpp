@@ -18,6 +18,8 @@
 #include "error.h"
 
 #include "atom_vec_bio.h"
+#include "fix_bio_kinetics.h"
+#include "modify.h"
 #include "force.h"
 #include "input.h"
 #include "pointers.h"
@@ -80,6 +82,14 @@ int FixDeath::setmask() {
 /* ---------------------------------------------------------------------- */
 
 void FixDeath::init() {
+  kinetics = NULL;
+  for (int j = 0; j < modify->nfix; j++) {
+    if (strcmp(modify->fix[j]->style, "kinetics") == 0) {
+      kinetics = static_cast<FixKinetics *>(modify->fix[j]);
+      break;
+    }
+  }
+
   ivar = input->variable->find(var);
   if (ivar < 0)
     error->all(FLERR, "Variable name for fix death does not exist");
@@ -99,7 +109,11 @@ void FixDeath::pre_exchange() {
   //if (next_reneighbor != update->ntimestep) return;
   if (nevery == 0)
     return;
-  if (update->ntimestep % nevery)
+  // follow the biological steps of fix kinetics when they are adaptive
+  if (kinetics != NULL && kinetics->adapt_flag) {
+    if (!kinetics->bio_step())
+      return;
+  } else if (update->ntimestep % nevery)
     return;
   if (demflag)
     return;
@@ -39,6 +39,7 @@ class FixDeath : public Fix {
 
   int demflag;
   double dead_dia;
+  class FixKinetics *kinetics;
 
   void death();
 };
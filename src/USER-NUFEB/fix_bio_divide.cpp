@@ -20,7 +20,9 @@
 #include "domain.h"
 #include "error.h"
 #include "bio.h"
+#include "bio_timer.h"
 #include "fix_bio_fluid.h"
+#include "fix_bio_kinetics.h"
 #include "force.h"
 #include "input.h"
 #include "lmptype.h"
@@ -133,6 +135,14 @@ int FixDivide::setmask() {
  ------------------------------------------------------------------------- */
 
 void FixDivide::init() {
+  kinetics = NULL;
+  for (int j = 0; j < modify->nfix; j++) {
+    if (strcmp(modify->fix[j]->style, "kinetics") == 0) {
+      kinetics = static_cast<FixKinetics *>(modify->fix[j]);
+      break;
+    }
+  }
+
   if (!atom->radius_flag)
     error->all(FLERR, "Fix divide requires atom attribute diameter");
 
@@ -161,13 +171,18 @@ void FixDivide::init() {
 void FixDivide::post_integrate() {
   if (nevery == 0)
     return;
-  if (update->ntimestep % nevery)
+  // follow the biological steps of fix kinetics when they are adaptive
+  if (kinetics != NULL && kinetics->adapt_flag) {
+    if (!kinetics->bio_step())
+      return;
+  } else if (update->ntimestep % nevery)
     return;
   if (nufebFoam != NULL && nufebFoam->demflag)
     return;
   if (demflag)
     return;
 
+  bio->timer->start(BioTimer::DIVIDE);
   int nlocal = atom->nlocal;
 
   for (int i = 0; i < nlocal; i++) {
@@ -318,6 +333,7 @@ void FixDivide::post_integrate() {
 
   // trigger immediate reneighboring
   next_reneighbor = update->ntimestep;
+  bio->timer->stop(BioTimer::DIVIDE);
 }
 
 /* ---------------------------------------------------------------------- */
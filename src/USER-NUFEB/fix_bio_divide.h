@@ -46,6 +46,7 @@ class FixDivide : public Fix {
   class AtomVecBio *avec;
   class BIO *bio;
   class FixFluid *nufebFoam;
+  class FixKinetics *kinetics;
 };
 
 }
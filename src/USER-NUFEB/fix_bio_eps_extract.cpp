@@ -17,10 +17,13 @@
 
 #include "atom.h"
 #include "atom_vec_bio.h"
+#include "bio.h"
+#include "bio_timer.h"
 #include "domain.h"
 #include "error.h"
 
 #include "fix_bio_fluid.h"
+#include "fix_bio_kinetics.h"
 #include "force.h"
 #include "input.h"
 #include "lmptype.h"
@@ -133,6 +136,14 @@ int FixEPSExtract::setmask() {
  ------------------------------------------------------------------------- */
 
 void FixEPSExtract::init() {
+  kinetics = NULL;
+  for (int j = 0; j < modify->nfix; j++) {
+    if (strcmp(modify->fix[j]->style, "kinetics") == 0) {
+      kinetics = static_cast<FixKinetics *>(modify->fix[j]);
+      break;
+    }
+  }
+
   // fprintf(stdout, "called once?\n");
   if (!atom->radius_flag)
     error->all(FLERR, "Fix eps extract requires atom attribute diameter");
@@ -181,13 +192,18 @@ void FixEPSExtract::init() {
 void FixEPSExtract::post_integrate() {
   if (nevery == 0)
     return;
-  if (update->ntimestep % nevery)
+  // follow the biological steps of fix kinetics when they are adaptive
+  if (kinetics != NULL && kinetics->adapt_flag) {
+    if (!kinetics->bio_step())
+      return;
+  } else if (update->ntimestep % nevery)
     return;
   if (nufebFoam != NULL && nufebFoam->demflag)
     return;
   if (demflag)
     return;
 
+  avec->bio->timer->start(BioTimer::EPS);
   int nlocal = atom->nlocal;
 
   for (int i = 0; i < nlocal; i++) {
@@ -288,6 +304,7 @@ void FixEPSExtract::post_integrate() {
 
   // trigger immediate reneighboring
   next_reneighbor = update->ntimestep;
+  avec->bio->timer->stop(BioTimer::EPS);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -48,6 +48,7 @@ class FixEPSExtract : public Fix {
   class RanPark *random;
   class AtomVecBio *avec;
   class FixFluid *nufebFoam;
+  class FixKinetics *kinetics;
 };
 }
 
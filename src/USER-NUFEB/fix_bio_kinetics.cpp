@@ -21,13 +21,16 @@
 #include "input.h"
 #include "memory.h"
 
+#include "anderson_mixer.h"
 #include "bio.h"
+#include "bio_timer.h"
 #include "atom_vec_bio.h"
 #include "fix_bio_kinetics_ph.h"
 #include "fix_bio_kinetics_thermo.h"
 #include "pointers.h"
 #include "variable.h"
 #include "modify.h"
+#include "newton_krylov.h"
 #include "update.h"
 #include "force.h"
 #include "group.h"
@@ -35,6 +38,7 @@
 #include "fix_bio_kinetics_diffusion.h"
 #include "fix_bio_kinetics_energy.h"
 #include "fix_bio_kinetics_monod.h"
+#include "fix_bio_kinetics_matrix.h"
 #include "fix_pso_growth_sc.h"
 #include "fix_pso_growth_tcell.h"
 #include "fix_pso_growth_ta.h"
@@ -61,6 +65,12 @@ using namespace std;
 
 #define BUFMIN 1000
 
+enum {PICARD, ANDERSON, JFNK};
+enum {DECOMP_ATOM, DECOMP_GRID};
+
+#define JFNK_MAXIT 50
+#define JFNK_RESTART 30
+
 /* ---------------------------------------------------------------------- */
 
 FixKinetics::FixKinetics(LAMMPS *lmp, int narg, char **arg) :
@@ -114,6 +124,37 @@ FixKinetics::FixKinetics(LAMMPS *lmp, int narg, char **arg) :
   demflag = 0;
   niter = -1;
   devery = 1;
+  devery_auto = 0;
+  devery_tol = 0.0;
+  devery_min = devery_max = 1;
+  nus_ref = NULL;
+  nus_change_max = NULL;
+  coupling = PICARD;
+  anderson_m = 0;
+  anderson = NULL;
+  newton = NULL;
+  coupling_vec = NULL;
+  coupling_nmax = 0;
+  adapt_flag = 0;
+  adapt_safety = 0.0;
+  adapt_min = adapt_max = 0;
+  mass_prev = NULL;
+  mass_nmax = 0;
+  stat_iter = stat_nevals = 0;
+  stat_conv = NULL;
+  stat_sweeps = NULL;
+  skip_tol = 0.0;
+  nskip = 0;
+  skip_valid = 0;
+  skip_nmax = 0;
+  xdensity_ref = NULL;
+  nubs_ref = NULL;
+  counters_flag = 0;
+  counters_fp = -1;
+  decomp = DECOMP_ATOM;
+  block_thresh = 0.0;
+  nremote = 0;
+  cell_nmax = 0;
 
   int iarg = 9;
   while (iarg < narg) {
@@ -136,24 +177,136 @@ FixKinetics::FixKinetics(LAMMPS *lmp, int narg, char **arg) :
       niter = force->inumeric(FLERR, arg[iarg + 1]);
       iarg += 2;
     } else if (strcmp(arg[iarg], "devery") == 0) {
-      devery = force->inumeric(FLERR, arg[iarg + 1]);
-      if (devery < 1)
-        error->all(FLERR, "Illegal fix kinetics command: devery");
+      if (iarg + 1 < narg && strcmp(arg[iarg + 1], "auto") == 0) {
+        if (iarg + 5 > narg)
+          error->all(FLERR, "Illegal fix kinetics command: devery auto");
+        devery_auto = 1;
+        devery_tol = force->numeric(FLERR, arg[iarg + 2]);
+        devery_min = force->inumeric(FLERR, arg[iarg + 3]);
+        devery_max = force->inumeric(FLERR, arg[iarg + 4]);
+        if (devery_tol <= 0.0 || devery_min < 1 || devery_max < devery_min)
+          error->all(FLERR, "Illegal fix kinetics command: devery auto");
+        devery = devery_min;
+        iarg += 5;
+      } else {
+        devery = force->inumeric(FLERR, arg[iarg + 1]);
+        if (devery < 1)
+          error->all(FLERR, "Illegal fix kinetics command: devery");
+        iarg += 2;
+      }
+    } else if (strcmp(arg[iarg], "adapt") == 0) {
+      if (iarg + 4 > narg)
+        error->all(FLERR, "Illegal fix kinetics command: adapt");
+      adapt_flag = 1;
+      adapt_safety = force->numeric(FLERR, arg[iarg + 1]);
+      adapt_min = force->inumeric(FLERR, arg[iarg + 2]);
+      adapt_max = force->inumeric(FLERR, arg[iarg + 3]);
+      if (adapt_safety <= 0.0 || adapt_min < 1 || adapt_max < adapt_min)
+        error->all(FLERR, "Illegal fix kinetics command: adapt");
+      iarg += 4;
+    } else if (strcmp(arg[iarg], "skip") == 0) {
+      if (iarg + 2 > narg)
+        error->all(FLERR, "Illegal fix kinetics command: skip");
+      skip_tol = force->numeric(FLERR, arg[iarg + 1]);
+      if (skip_tol < 0.0)
+        error->all(FLERR, "Illegal fix kinetics command: skip");
+      iarg += 2;
+    } else if (strcmp(arg[iarg], "coupling") == 0) {
+      if (iarg + 1 >= narg)
+        error->all(FLERR, "Illegal fix kinetics command: coupling");
+      if (strcmp(arg[iarg + 1], "picard") == 0) {
+        coupling = PICARD;
+        iarg += 2;
+      } else if (strcmp(arg[iarg + 1], "anderson") == 0) {
+        if (iarg + 2 >= narg)
+          error->all(FLERR, "Illegal fix kinetics command: coupling anderson");
+        coupling = ANDERSON;
+        anderson_m = force->inumeric(FLERR, arg[iarg + 2]);
+        if (anderson_m < 1)
+          error->all(FLERR, "Illegal fix kinetics command: coupling anderson");
+        iarg += 3;
+      } else if (strcmp(arg[iarg + 1], "jfnk") == 0) {
+        coupling = JFNK;
+        iarg += 2;
+      } else
+        error->all(FLERR, "Illegal fix kinetics command: coupling");
+    } else if (strcmp(arg[iarg], "counters") == 0) {
+      if (iarg + 1 >= narg)
+        error->all(FLERR, "Illegal fix kinetics command: counters");
+      if (strcmp(arg[iarg + 1], "yes") == 0) {
+        counters_flag = 1;
+        iarg += 2;
+      } else if (strcmp(arg[iarg + 1], "no") == 0) {
+        counters_flag = 0;
+        iarg += 2;
+      } else if (strcmp(arg[iarg + 1], "fp") == 0) {
+        // raw event code of the FP operations counter, CPU specific
+        if (iarg + 2 >= narg)
+          error->all(FLERR, "Illegal fix kinetics command: counters fp");
+        char *end;
+        counters_flag = 1;
+        counters_fp = strtol(arg[iarg + 2], &end, 0);
+        if (*end != '\0' || counters_fp < 0)
+          error->all(FLERR, "Illegal fix kinetics command: counters fp");
+        iarg += 3;
+      } else
+        error->all(FLERR, "Illegal fix kinetics command: counters");
+    } else if (strcmp(arg[iarg], "decomp") == 0) {
+      if (iarg + 1 >= narg)
+        error->all(FLERR, "Illegal fix kinetics command: decomp");
+      if (strcmp(arg[iarg + 1], "atom") == 0)
+        decomp = DECOMP_ATOM;
+      else if (strcmp(arg[iarg + 1], "grid") == 0)
+        decomp = DECOMP_GRID;
+      else
+        error->all(FLERR, "Illegal fix kinetics command: decomp");
       iarg += 2;
+      if (decomp == DECOMP_GRID && iarg < narg && strcmp(arg[iarg], "block") == 0) {
+        if (iarg + 3 > narg)
+          error->all(FLERR, "Illegal fix kinetics command: decomp grid block");
+        partition.block = force->inumeric(FLERR, arg[iarg + 1]);
+        block_thresh = force->numeric(FLERR, arg[iarg + 2]);
+        if (partition.block < 1 || block_thresh < 1.0)
+          error->all(FLERR, "Illegal fix kinetics command: decomp grid block");
+        iarg += 3;
+      }
     } else
       error->all(FLERR, "Illegal fix kinetics command");
   }
 
+  if (counters_flag)
+    bio->timer->enable_counters(counters_fp);
+
+  if (coupling == ANDERSON)
+    anderson = new AndersonMixer(lmp, anderson_m);
+  if (coupling == JFNK)
+    newton = new NewtonKrylov(lmp, this, JFNK_RESTART);
+
+  if (adapt_flag && nevery == 0)
+    error->all(FLERR, "Illegal fix kinetics command: adapt requires nevery > 0");
+  if (decomp == DECOMP_GRID && comm->style != 0)
+    error->all(FLERR, "Illegal fix kinetics command: decomp grid requires comm_style brick");
+  bio_nevery = nevery;
+  next_bio = 0;
+
   stepx = (xhi - xlo) / nx;
   stepy = (yhi - ylo) / ny;
   stepz = (zhi - zlo) / nz;
 
   grid = Grid<double, 3>(Box<double, 3>(domain->boxlo, domain->boxhi), { nx, ny, nz });
+  if (decomp == DECOMP_GRID) {
+    int n[3] = {nx, ny, nz};
+    for (int i = 0; i < 3; i++)
+      if (partition.nblocks(n, i) < comm->procgrid[i])
+        error->all(FLERR, "Illegal fix kinetics command: fewer grid blocks than procs");
+    partition.balance(comm, n, nz);
+  }
   double tmpsublo[3], tmpsubhi[3];
+  sub_box(tmpsublo, tmpsubhi);
   const double small = 1e-12;
   for (int i = 0; i < 3; i++) {
-    tmpsublo[i] = domain->sublo[i] + small;
-    tmpsubhi[i] = domain->subhi[i] + small;
+    tmpsublo[i] += small;
+    tmpsubhi[i] += small;
   }
   subgrid = Subgrid<double, 3>(grid, Box<double, 3>(tmpsublo, tmpsubhi));
 
@@ -168,6 +321,14 @@ FixKinetics::FixKinetics(LAMMPS *lmp, int narg, char **arg) :
 
   bnz = subgrid.get_box().upper[2];
   maxheight = domain->boxhi[2];
+
+  atom_cell = NULL;
+  cell_start = NULL;
+  cell_atoms = NULL;
+  nbinned = 0;
+  bin_stamp = -1;
+  bin_nmax = 0;
+  bin_ngrids = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -190,6 +351,19 @@ FixKinetics::~FixKinetics() {
   memory->destroy(sh);
   memory->destroy(fv);
   memory->destroy(xdensity);
+  memory->destroy(nus_ref);
+  memory->destroy(nus_change_max);
+  memory->destroy(coupling_vec);
+  memory->destroy(xdensity_ref);
+  memory->destroy(mass_prev);
+  memory->destroy(stat_conv);
+  memory->destroy(stat_sweeps);
+  memory->destroy(nubs_ref);
+  delete anderson;
+  delete newton;
+  memory->destroy(atom_cell);
+  memory->destroy(cell_start);
+  memory->destroy(cell_atoms);
 
   delete[] nuconv;
 }
@@ -199,6 +373,7 @@ FixKinetics::~FixKinetics() {
 int FixKinetics::setmask() {
   int mask = 0;
   mask |= PRE_FORCE;
+  mask |= POST_RUN;
   return mask;
 }
 
@@ -216,12 +391,18 @@ void FixKinetics::init() {
   diff_dt = input->variable->compute_equal(ivar[0]);
   blayer = input->variable->compute_equal(ivar[1]);
 
+  if (adapt_flag && next_bio <= update->ntimestep)
+    next_bio = update->ntimestep + bio_nevery;
+
+  bio->timer->reset();
+
   // register fix kinetics with this class
   diffusion = NULL;
   energy = NULL;
   ph = NULL;
   thermo = NULL;
   monod = NULL;
+  matrix = NULL;
   nufebfoam = NULL;
 
   //DINIKA MOD - register fix growth with this class
@@ -242,6 +423,8 @@ void FixKinetics::init() {
       thermo = static_cast<FixKineticsThermo *>(lmp->modify->fix[j]);
     } else if (strcmp(modify->fix[j]->style, "kinetics/growth/monod") == 0) {
       monod = static_cast<FixKineticsMonod *>(lmp->modify->fix[j]);
+    } else if (strcmp(modify->fix[j]->style, "kinetics/growth/matrix") == 0) {
+      matrix = static_cast<FixKineticsMatrix *>(lmp->modify->fix[j]);
     } else if (strcmp(modify->fix[j]->style, "nufebFoam") == 0) {
       nufebfoam = static_cast<FixFluid *>(lmp->modify->fix[j]);
     } else if (strcmp(modify->fix[j]->style, "psoriasis/growth/sc") == 0) { // DINIKA MOD
@@ -268,6 +451,21 @@ void FixKinetics::init() {
       error->all(FLERR, "fix_kinetics requires fix_kinetics/ph");
     if (monod != NULL)
       error->all(FLERR, "kinetics/growth/monod and kinetics/growth/energy cannot be defined at the same time");
+    if (matrix != NULL)
+      error->all(FLERR, "kinetics/growth/matrix and kinetics/growth/energy cannot be defined at the same time");
+  }
+  if (monod != NULL && matrix != NULL)
+    error->all(FLERR, "kinetics/growth/monod and kinetics/growth/matrix cannot be defined at the same time");
+
+  // these index nus and nur by the cell of each atom, which may be a
+  // remote column, or move the subdomains the grid decomposition ignores
+  if (decomp == DECOMP_GRID) {
+    if (psosc != NULL || psotcell != NULL || psota != NULL || psodiff != NULL)
+      error->all(FLERR, "Fix kinetics decomp grid cannot be used with the psoriasis growth fixes");
+    for (int j = 0; j < nfix; j++)
+      if (strcmp(modify->fix[j]->style, "kinetics/balance") == 0 ||
+          strcmp(modify->fix[j]->style, "kinetics/balance/cost") == 0)
+        error->all(FLERR, "Fix kinetics decomp grid cannot be used with fix kinetics/balance");
   }
 
   ngrids = subn[0] * subn[1] * subn[2];
@@ -286,6 +484,14 @@ void FixKinetics::init() {
   sh = memory->create(sh, ngrids, "kinetics:sh");
   fv = memory->create(fv, 3, ngrids, "kinetcis:fv");
   xdensity = memory->create(xdensity, ntypes + 1, ngrids, "kinetics:xdensity");
+  cell_nmax = ngrids;
+  if (devery_auto) {
+    nus_ref = memory->grow(nus_ref, nnus + 1, ngrids, "kinetics:nus_ref");
+    nus_change_max = memory->grow(nus_change_max, 2 * nnus, "kinetics:nus_change_max");
+  }
+  stat_conv = memory->grow(stat_conv, nnus + 1, "kinetics:stat_conv");
+  stat_sweeps = memory->grow(stat_sweeps, nnus + 1, "kinetics:stat_sweeps");
+  for (int i = 0; i <= nnus; i++) stat_conv[i] = stat_sweeps[i] = 0;
 
   // Fitting initial domain decomposition to the grid 
   for (int i = 0; i < comm->procgrid[0]; i++) {
@@ -340,17 +546,84 @@ void FixKinetics::init_param() {
 void FixKinetics::pre_force(int vflag) {
   bool flag = true;
 
-  if (nevery == 0)
-    flag = false;
-  if (update->ntimestep % nevery)
+  if (!bio_step())
     flag = false;
   if (nufebfoam != NULL && nufebfoam->demflag)
     flag = false;
   if (demflag)
     flag = false;
 
-  if (flag)
+  if (flag) {
     integration();
+    if (adapt_flag)
+      adapt_nevery();
+  }
+
+  // a step suppressed by demflag still moves the next biological step
+  // on, as it does with a fixed nevery, so next_bio never falls behind
+  if (adapt_flag && bio_step())
+    next_bio = update->ntimestep + bio_nevery;
+}
+
+/* ----------------------------------------------------------------------
+ return true if the current timestep is a biological step, i.e. fix
+ kinetics runs in this timestep
+ ------------------------------------------------------------------------- */
+bool FixKinetics::bio_step() {
+  if (nevery == 0)
+    return false;
+  if (adapt_flag)
+    return update->ntimestep >= next_bio;
+  return (update->ntimestep % nevery) == 0;
+}
+
+/* ----------------------------------------------------------------------
+ choose the # of timesteps until the next biological step from the
+ largest relative growth rate of the particles and the largest relative
+ nutrient consumption rate of the grids in the step just taken
+ ------------------------------------------------------------------------- */
+void FixKinetics::adapt_nevery() {
+  double dt = update->dt * bio_nevery;
+  double local[2] = {0.0, 0.0};
+
+  // relative growth rate of the particles
+  for (int i = 0; i < atom->nlocal; i++) {
+    if (mass_prev[i] > 0.0 && atom->rmass[i] > 0.0)
+      local[0] = MAX(local[0], fabs(log(atom->rmass[i] / mass_prev[i])) / dt);
+  }
+
+  // relative depletion rate of liquid nutrients
+  for (int nu = 1; nu <= bio->nnu; nu++) {
+    if (bio->nustate[nu] != 0)
+      continue;
+    for (int j = 0; j < bgrids; j++) {
+      if (nur[nu][j] < 0.0 && nus[nu][j] > 0.0)
+        local[1] = MAX(local[1], -nur[nu][j] / nus[nu][j]);
+    }
+  }
+
+  double global[2];
+  MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_MAX, world);
+
+  // particles may grow by at most a fraction of a doubling, i.e. of the
+  // mass gained between two divisions, and nutrients may be depleted by
+  // at most a fraction of their local concentration
+  double dt_new = update->dt * adapt_max;
+  if (global[0] > 0.0)
+    dt_new = MIN(dt_new, adapt_safety * log(2.0) / global[0]);
+  if (global[1] > 0.0)
+    dt_new = MIN(dt_new, adapt_safety / global[1]);
+
+  bigint n = static_cast<bigint>(dt_new / update->dt);
+  n = MIN(n, 2 * (bigint) bio_nevery);
+  n = MAX(n, (bigint) adapt_min);
+  n = MIN(n, (bigint) adapt_max);
+  bio_nevery = static_cast<int>(n);
+
+  if (comm->me == 0 && logfile)
+    fprintf(logfile, "biological timestep: %i steps \n", bio_nevery);
+  if (comm->me == 0 && screen)
+    fprintf(screen, "biological timestep: %i steps \n", bio_nevery);
 }
 
 /* ----------------------------------------------------------------------
@@ -360,48 +633,117 @@ void FixKinetics::integration() {
   int iteration = 0;
   bool converge = false;
   int nnus = bio->nnu;
+  int last_eval = 0;               // iteration of the last reaction evaluation
+  int interval = devery;           // # of iterations the reaction terms are applied for
+  int nevals = 0;                  // # of reaction evaluations
 
   grow_flag = 0;
   update_bgrids();
+  bin_atoms();
   update_xdensity();
+  // the block costs read the biomass binned above, a new partition needs
+  // the atoms binned again to its grid
+  if (decomp == DECOMP_GRID && repartition()) {
+    bin_atoms();
+    update_xdensity();
+  }
+
+  stat_iter = stat_nevals = 0;
+  for (int i = 0; i <= nnus; i++) stat_conv[i] = stat_sweeps[i] = 0;
+  bio->timer->mark();
+  if (ph != NULL) ph->newton_iters = 0;
 
   // update grid biomass to calculate diffusion coeff
-  if (diffusion != NULL) {
+  if (diffusion != NULL && !skip_solve()) {
     if (diffusion->dcflag) diffusion->update_diff_coeff();
 
+    if (coupling != PICARD) {
+      int n = bio->nnu * bgrids;
+      if (n > coupling_nmax) {
+        coupling_nmax = n;
+        memory->destroy(coupling_vec);
+        memory->create(coupling_vec, coupling_nmax, "kinetics:coupling_vec");
+      }
+    }
+    if (anderson)
+      anderson->reset(pack_nus(coupling_vec));
+
+    // Newton-Krylov replaces the Picard loop below
+    if (newton) {
+      int n = pack_nus(coupling_vec);
+      int maxit = niter > 0 ? niter : JFNK_MAXIT;
+      iteration = newton->solve(coupling_vec, n, diffusion->tol, maxit);
+      nevals = newton->get_nevals();
+      unpack_nus(coupling_vec);
+      diffusion->restore_nugrid();
+      // apply gas-liquid transfer once with the converged concentrations
+      evaluate_reactions(diff_dt);
+      converge = true;
+    }
+
     while (!converge) {
       converge = true;
 
       // solve for reaction term, no growth happens here
-      if (iteration % devery == 0) {
-        reset_nur();
-        if (energy != NULL) {
-          ph->solve_ph();
-          thermo->thermo(diff_dt * devery);
-          energy->growth(diff_dt * devery, grow_flag);
-        } else if (monod != NULL) {
-          monod->growth(diff_dt * devery, grow_flag);
-        } else if (psosc != NULL) {				//DINIKA MOD
-            psosc->growth(diff_dt * devery, grow_flag);
-        } else if (psotcell != NULL) {
-        	psotcell->growth(diff_dt * devery, grow_flag);
-        } else if (psota != NULL){
-        	psota->growth(diff_dt * devery, grow_flag);
-        } else if (psodiff != NULL){
-        	psodiff->growth(diff_dt * devery, grow_flag);
+      bool evaluate;
+      if (!devery_auto) {
+        evaluate = (iteration % devery == 0);
+      } else {
+        // re-evaluate once nus has drifted from the last evaluation,
+        // within [devery_min, devery_max] iterations
+        int since = iteration - last_eval;
+        if (iteration == 0 || since >= devery_max)
+          evaluate = true;
+        else if (since < devery_min)
+          evaluate = false;
+        else
+          evaluate = nus_change() > devery_tol;
+      }
+
+      if (evaluate) {
+        // reaction terms are applied until the next evaluation, which is
+        // assumed to come after as many iterations as the previous one
+        if (iteration > 0)
+          interval = iteration - last_eval;
+        last_eval = iteration;
+        nevals++;
+
+        // the sweeps since the last evaluation map the previous nus
+        // iterate to the current one; extrapolate from their history
+        if (anderson) {
+          pack_nus(coupling_vec);
+          anderson->mix(coupling_vec);
+          unpack_nus(coupling_vec);
+          diffusion->restore_nugrid();
         }
+
+        evaluate_reactions(diff_dt * interval);
+
+        // new reaction terms, every nutrient has to converge again
+        reset_isconv();
+
+        if (devery_auto)
+          save_nus_ref();
       }
 
       iteration++;
 
-      // solve for diffusion and advection
-      nuconv = diffusion->diffusion(nuconv, iteration, diff_dt);
+      // solve for diffusion and advection, nutrients that converged since
+      // the last reaction evaluation are not swept
+      for (int i = 1; i <= nnus; i++)
+        if (bio->nustate[i] == 0 && !nuconv[i]) stat_sweeps[i]++;
+      nuconv = diffusion->diffusion(nuconv, diff_dt);
+
+      for (int i = 1; i <= nnus; i++) {
+        if (!nuconv[i]) stat_conv[i] = 0;
+        else if (!stat_conv[i]) stat_conv[i] = iteration;
+      }
 
-      // check for convergence
+      // check for convergence, a nutrient keeps its flag until the next
+      // reaction evaluation
       for (int i = 1; i <= nnus; i++) {
         if (!nuconv[i]) {
           converge = false;
-          reset_isconv();
           break;
         }
       }
@@ -414,8 +756,18 @@ void FixKinetics::integration() {
       fprintf(logfile, "number of iterations: %i \n", iteration);
     if (comm->me == 0 && screen)
       fprintf(screen, "number of iterations: %i \n", iteration);
+    if (devery_auto) {
+      if (comm->me == 0 && logfile)
+        fprintf(logfile, "number of reaction evaluations: %i \n", nevals);
+      if (comm->me == 0 && screen)
+        fprintf(screen, "number of reaction evaluations: %i \n", nevals);
+    }
 
     reset_isconv();
+    if (skip_tol > 0.0)
+      save_skip_ref();
+    stat_iter = iteration;
+    stat_nevals = nevals;
   } else {
     converge = true;
   }
@@ -423,24 +775,40 @@ void FixKinetics::integration() {
   grow_flag = 1;
   reset_nur();
 
+  // keep the pre-growth mass for the biological timestep controller
+  if (adapt_flag) {
+    if (atom->nmax > mass_nmax) {
+      mass_nmax = atom->nmax;
+      memory->destroy(mass_prev);
+      memory->create(mass_prev, mass_nmax, "kinetics:mass_prev");
+    }
+    for (int i = 0; i < atom->nlocal; i++)
+      mass_prev[i] = atom->rmass[i];
+  }
+
   // microbe growth
+  bio->timer->start(BioTimer::GROWTH);
   if (energy != NULL)
-    energy->growth(update->dt * nevery, grow_flag);
+    energy->growth(update->dt * bio_nevery, grow_flag);
   if (monod != NULL)
-    monod->growth(update->dt * nevery, grow_flag);
+    monod->growth(update->dt * bio_nevery, grow_flag);
+  if (matrix != NULL)
+    matrix->growth(update->dt * bio_nevery, grow_flag);
   //DINIKA MOD
   if (psosc != NULL)
-     psosc->growth(update->dt * nevery, grow_flag);
+     psosc->growth(update->dt * bio_nevery, grow_flag);
   if (psotcell != NULL)
-	  psotcell->growth(update->dt * nevery, grow_flag);
+	  psotcell->growth(update->dt * bio_nevery, grow_flag);
   if (psota != NULL)
-	  psota->growth(update->dt * nevery, grow_flag);
+	  psota->growth(update->dt * bio_nevery, grow_flag);
   if (psodiff != NULL)
-  	  psodiff->growth(update->dt * nevery, grow_flag);
+  	  psodiff->growth(update->dt * bio_nevery, grow_flag);
 
   if (ph != NULL && ph->buffer_flag)
     ph->buffer_ph();
+  bio->timer->stop(BioTimer::GROWTH);
 
+  bio->timer->start(BioTimer::BULK);
   if (diffusion != NULL) {
     // manually update reaction if none of the surface is using dirichlet BC
     diffusion->update_nus();
@@ -451,7 +819,8 @@ void FixKinetics::integration() {
   }
 
   if (thermo != NULL)
-    thermo->thermo(update->dt * nevery);
+    thermo->thermo(update->dt * bio_nevery);
+  bio->timer->stop(BioTimer::BULK);
 }
 
 /* ----------------------------------------------------------------------
@@ -484,29 +853,249 @@ void FixKinetics::update_bgrids() {
     if (new_bnz != bnz)
     {
       bnz = new_bnz;
-      bgrids = subn[0] * subn[1] * MIN(subn[2], MAX(0, bnz - subnlo[2]));
-      double tmpsublo[3], tmpsubhi[3];
-      const double small = 1e-12;
-      for (int i = 0; i < 3; i++) {
-        tmpsublo[i] = domain->sublo[i] + small;
-        if (i == 2)
-          tmpsubhi[i] = min(domain->subhi[i] + small, bnz * stepz);
-        else
-          tmpsubhi[i] = domain->subhi[i] + small;
-      }
-      subgrid = Subgrid<double, 3>(grid, Box<double, 3>(tmpsublo, tmpsubhi));
-      diffusion->setup_exchange_flag = true;
+      trim_subgrid();
     }
   } else {
     bgrids = subn[0] * subn[1] * subn[2];
   }
 }
 
+/* ----------------------------------------------------------------------
+ trim the subgrid to the boundary layer and update bgrids
+ ------------------------------------------------------------------------- */
+void FixKinetics::trim_subgrid() {
+  if (blayer < 0) {
+    bgrids = subn[0] * subn[1] * subn[2];
+    return;
+  }
+
+  bgrids = subn[0] * subn[1] * MIN(subn[2], MAX(0, bnz - subnlo[2]));
+  double tmpsublo[3], tmpsubhi[3];
+  sub_box(tmpsublo, tmpsubhi);
+  const double small = 1e-12;
+  for (int i = 0; i < 3; i++) {
+    tmpsublo[i] += small;
+    tmpsubhi[i] += small;
+  }
+  tmpsubhi[2] = min(tmpsubhi[2], bnz * stepz);
+  subgrid = Subgrid<double, 3>(grid, Box<double, 3>(tmpsublo, tmpsubhi));
+  if (diffusion != NULL)
+    diffusion->setup_exchange_flag = true;
+}
+
+/* ----------------------------------------------------------------------
+ bounds of the grid subdomain of this proc, the particle subdomain
+ unless the grid has its own partition
+ ------------------------------------------------------------------------- */
+void FixKinetics::sub_box(double *lo, double *hi) {
+  if (decomp == DECOMP_GRID) {
+    Box<int, 3> box = partition.mybox(comm);
+    double step[3] = {stepx, stepy, stepz};
+    for (int i = 0; i < 3; i++) {
+      lo[i] = domain->boxlo[i] + box.lower[i] * step[i];
+      hi[i] = domain->boxlo[i] + box.upper[i] * step[i];
+    }
+  } else {
+    for (int i = 0; i < 3; i++) {
+      lo[i] = domain->sublo[i];
+      hi[i] = domain->subhi[i];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+ rebalance the grid partition, migrating the grid when a cut moves, and
+ return true if it did. without blocks the cuts follow the active cells;
+ with blocks they move whole blocks by their cost once the imbalance
+ exceeds block_thresh
+ ------------------------------------------------------------------------- */
+bool FixKinetics::repartition() {
+  GridPartition next;
+  next.block = partition.block;
+  int n[3] = {nx, ny, nz};
+  if (block_thresh > 0.0) {
+    std::vector<double> profile[3];
+    double load = block_profiles(profile);
+    double maxload;
+    MPI_Allreduce(&load, &maxload, 1, MPI_DOUBLE, MPI_MAX, world);
+    double total = 0.0;
+    for (size_t i = 0; i < profile[0].size(); i++)
+      total += profile[0][i];
+    // each proc holds exactly its partition box, so loads are exact
+    if (total <= 0.0 || maxload * comm->nprocs / total <= block_thresh)
+      return false;
+    next.balance(comm, n, profile);
+  } else {
+    next.balance(comm, n, blayer >= 0 ? bnz : nz);
+  }
+  if (next == partition)
+    return false;
+
+  partition = next;
+  migrate();
+  return true;
+}
+
+/* ----------------------------------------------------------------------
+ cost of the grid blocks projected on each dimension, summed over procs,
+ and return the cost of the local grid: one for each active grid, for
+ the diffusion sweeps, and one more if it holds biomass, for the
+ reaction terms
+ ------------------------------------------------------------------------- */
+double FixKinetics::block_profiles(std::vector<double> *profile) {
+  int n[3] = {nx, ny, nz};
+  int nb[3];
+  for (int i = 0; i < 3; i++)
+    nb[i] = partition.nblocks(n, i);
+  int block = partition.block;
+  std::vector<double> local(nb[0] + nb[1] + nb[2], 0.0);
+  double load = 0.0;
+
+  for (int j = 0; j < bgrids; j++) {
+    int c[3] = {j % subn[0], (j / subn[0]) % subn[1], j / (subn[0] * subn[1])};
+    double w = xdensity[0][j] > 0.0 ? 2.0 : 1.0;
+    int offset = 0;
+    for (int i = 0; i < 3; i++) {
+      local[offset + (subnlo[i] + c[i]) / block] += w;
+      offset += nb[i];
+    }
+    load += w;
+  }
+
+  std::vector<double> global(local.size());
+  MPI_Allreduce(local.data(), global.data(), local.size(), MPI_DOUBLE, MPI_SUM, world);
+  int offset = 0;
+  for (int i = 0; i < 3; i++) {
+    profile[i].assign(global.begin() + offset, global.begin() + offset + nb[i]);
+    offset += nb[i];
+  }
+  return load;
+}
+
+/* ---------------------------------------------------------------------- */
+
+const GridPartition *FixKinetics::get_partition() const {
+  return decomp == DECOMP_GRID ? &partition : NULL;
+}
+
+/* ----------------------------------------------------------------------
+ return true if the biomass density and the bulk concentrations have
+ changed by less than skip_tol since the last steady-state solve, in
+ which case the last solution is reused
+ ------------------------------------------------------------------------- */
+bool FixKinetics::skip_solve() {
+  if (skip_tol <= 0.0 || !skip_valid)
+    return false;
+
+  // local[2] flags a proc whose boundary layer has moved
+  double local[3] = {0.0, 0.0, 0.0};
+  if (bgrids != skip_bgrids) {
+    local[2] = 1.0;
+  } else {
+    for (int j = 0; j < bgrids; j++) {
+      local[0] = MAX(local[0], fabs(xdensity[0][j] - xdensity_ref[j]));
+      local[1] = MAX(local[1], fabs(xdensity_ref[j]));
+    }
+  }
+  double global[3];
+  MPI_Allreduce(local, global, 3, MPI_DOUBLE, MPI_MAX, world);
+  if (global[2] > 0.0)
+    return false;
+
+  double change = 0.0;
+  if (global[1] > 0.0)
+    change = global[0] / global[1];
+  else if (global[0] > 0.0)
+    return false;
+
+  // nubs is identical on all procs
+  for (int nu = 1; nu <= bio->nnu; nu++) {
+    double ref = fabs(nubs_ref[nu]);
+    double diff = fabs(nubs[nu] - nubs_ref[nu]);
+    if (ref > 0.0)
+      change = MAX(change, diff / ref);
+    else if (diff > 0.0)
+      return false;
+  }
+
+  if (change >= skip_tol)
+    return false;
+
+  nskip++;
+  if (comm->me == 0 && logfile)
+    fprintf(logfile, "steady-state solve skipped, number of skipped solves: %i \n", nskip);
+  if (comm->me == 0 && screen)
+    fprintf(screen, "steady-state solve skipped, number of skipped solves: %i \n", nskip);
+
+  return true;
+}
+
+/* ----------------------------------------------------------------------
+ store the biomass density and bulk concentrations of a steady-state solve
+ ------------------------------------------------------------------------- */
+void FixKinetics::save_skip_ref() {
+  if (bgrids > skip_nmax) {
+    skip_nmax = bgrids;
+    memory->destroy(xdensity_ref);
+    memory->create(xdensity_ref, skip_nmax, "kinetics:xdensity_ref");
+  }
+  if (nubs_ref == NULL)
+    memory->create(nubs_ref, bio->nnu + 1, "kinetics:nubs_ref");
+
+  for (int j = 0; j < bgrids; j++)
+    xdensity_ref[j] = xdensity[0][j];
+  for (int nu = 1; nu <= bio->nnu; nu++)
+    nubs_ref[nu] = nubs[nu];
+
+  skip_bgrids = bgrids;
+  skip_valid = 1;
+}
+
+/* ----------------------------------------------------------------------
+ evaluate reaction terms (nur) for the current nus, no growth happens here
+ ------------------------------------------------------------------------- */
+void FixKinetics::evaluate_reactions(double dt) {
+  bio->timer->start(BioTimer::REACTION);
+  reset_nur();
+  if (energy != NULL) {
+    bio->timer->start(BioTimer::PH);
+    ph->solve_ph();
+    bio->timer->stop(BioTimer::PH);
+    bio->timer->start(BioTimer::ENERGY);
+    thermo->thermo(dt);
+    energy->growth(dt, grow_flag);
+    bio->timer->stop(BioTimer::ENERGY);
+  } else if (monod != NULL) {
+    monod->growth(dt, grow_flag);
+  } else if (matrix != NULL) {
+    matrix->growth(dt, grow_flag);
+  } else if (psosc != NULL) {				//DINIKA MOD
+      psosc->growth(dt, grow_flag);
+  } else if (psotcell != NULL) {
+  	psotcell->growth(dt, grow_flag);
+  } else if (psota != NULL){
+  	psota->growth(dt, grow_flag);
+  } else if (psodiff != NULL){
+  	psodiff->growth(dt, grow_flag);
+  }
+  bio->timer->stop(BioTimer::REACTION);
+}
+
+/* ----------------------------------------------------------------------
+ residual of the steady reaction-diffusion equations at the liquid nus
+ packed in x; reactions are evaluated with timestep dt
+ ------------------------------------------------------------------------- */
+void FixKinetics::coupling_residual(const double *x, double *res, double dt) {
+  unpack_nus(x);
+  diffusion->restore_nugrid();
+  evaluate_reactions(dt);
+  diffusion->residual(res);
+}
+
 /* ----------------------------------------------------------------------
  update biomass density
  ------------------------------------------------------------------------- */
 void FixKinetics::update_xdensity() {
-  int *mask = atom->mask;
   int nlocal = atom->nlocal;
   double vol = stepx * stepy * stepz;
 
@@ -514,15 +1103,22 @@ void FixKinetics::update_xdensity() {
     for (int j = 0; j < bgrids; j++) {
       xdensity[i][j] = 0;
     }
+    for (int j = ngrids; j < ngrids + nremote; j++) {
+      xdensity[i][j] = 0;
+    }
   }
 
   for (int i = 0; i < nlocal; i++) {
-    int pos = position(i);
+    int pos = atom_cell[i];
     int t = atom->type[i];
     double xmass = atom->rmass[i] / vol;
     xdensity[t][pos] += xmass;
     xdensity[0][pos] += xmass;
   }
+
+  // add the density of local atoms in remote cells to their owners
+  if (decomp == DECOMP_GRID)
+    redist.reverse(world, xdensity, atom->ntypes + 1, ngrids);
 }
 
 bool FixKinetics::is_inside(int i) {
@@ -533,22 +1129,164 @@ bool FixKinetics::is_inside(int i) {
 }
 
 /* ----------------------------------------------------------------------
- get grid index of atom i
+ bin local atoms to grids with a counting sort; atom_cell[i] is the grid
+ of atom i and the atoms in grid g are cell_atoms[cell_start[g]] to
+ cell_atoms[cell_start[g+1]-1], in increasing index order.
+ with decomp grid, atoms in cells owned by another proc get the column
+ ngrids + s of remote cell s and follow cell_start[bgrids] in cell_atoms
  ------------------------------------------------------------------------- */
-int FixKinetics::position(int i) {
-  // get index of grid containing i
-  int xpos = (atom->x[i][0] - sublo[0]) / stepz;
-  int ypos = (atom->x[i][1] - sublo[1]) / stepz;
-  int zpos = (atom->x[i][2] - sublo[2]) / stepz;
-  int pos = xpos + ypos * subn[0] + zpos * subn[0] * subn[1];
+void FixKinetics::bin_atoms() {
+  int nlocal = atom->nlocal;
 
-  if (pos >= bgrids) {
-    printf("Too big! pos=%d   size = %i\n", pos, bgrids);
+  if (nlocal > bin_nmax) {
+    bin_nmax = atom->nmax;
+    memory->destroy(atom_cell);
+    memory->destroy(cell_atoms);
+    memory->create(atom_cell, bin_nmax, "kinetics:atom_cell");
+    memory->create(cell_atoms, bin_nmax, "kinetics:cell_atoms");
   }
+  if (bgrids + 1 > bin_ngrids) {
+    bin_ngrids = bgrids + 1;
+    memory->destroy(cell_start);
+    memory->create(cell_start, bin_ngrids, "kinetics:cell_start");
+  }
+
+  for (int g = 0; g <= bgrids; g++)
+    cell_start[g] = 0;
+
+  double **x = atom->x;
+  int n[3] = {nx, ny, nz};
+  std::vector<std::pair<int, int> > remote;   // owner and id of the cell of each remote atom
+  for (int i = 0; i < nlocal; i++) {
+    int c[3];
+    if (decomp == DECOMP_GRID) {
+      bool inside = true;
+      for (int k = 0; k < 3; k++) {
+        c[k] = static_cast<int>((x[i][k] - domain->boxlo[k]) / stepz);
+        c[k] = MAX(0, MIN(n[k] - 1, c[k]));
+        inside = inside && c[k] >= subnlo[k] && c[k] < subnhi[k];
+      }
+      if (!inside) {
+        atom_cell[i] = -1;
+        remote.push_back(std::make_pair(partition.owner(comm, c), c[0] + c[1] * nx + c[2] * nx * ny));
+        continue;
+      }
+      for (int k = 0; k < 3; k++)
+        c[k] -= subnlo[k];
+    } else {
+      for (int k = 0; k < 3; k++) {
+        c[k] = static_cast<int>((x[i][k] - sublo[k]) / stepz);
+        c[k] = MAX(0, MIN(subn[k] - 1, c[k]));
+      }
+    }
+    int pos = cell_index(c);
+    atom_cell[i] = pos;
+    cell_start[pos + 1]++;
+  }
+
+  if (decomp == DECOMP_GRID)
+    setup_redist(remote);
+
+  // cell_start[g+1] becomes the end of grid g, then filling backwards
+  // leaves cell_start[g+1] at the start of grid g
+  for (int g = 0; g < bgrids; g++)
+    cell_start[g + 1] += cell_start[g];
+  int nin = cell_start[bgrids];
+  for (int i = nlocal - 1; i >= 0; i--)
+    if (atom_cell[i] < ngrids)
+      cell_atoms[--cell_start[atom_cell[i] + 1]] = i;
+  for (int g = 0; g < bgrids; g++)
+    cell_start[g] = cell_start[g + 1];
+  cell_start[bgrids] = nin;
+  for (int i = 0; i < nlocal; i++)
+    if (atom_cell[i] >= ngrids)
+      cell_atoms[nin++] = i;
+
+  nbinned = nlocal;
+  bin_stamp = update->ntimestep;
+}
 
+/* ----------------------------------------------------------------------
+ local index of the grid with subdomain coordinates c. update_bgrids()
+ puts the boundary layer above the highest particle, so a particle grid
+ outside of the active grids is an error
+ ------------------------------------------------------------------------- */
+int FixKinetics::cell_index(const int *c) {
+  int pos = c[0] + c[1] * subn[0] + c[2] * subn[0] * subn[1];
+  if (pos >= bgrids)
+    error->one(FLERR, "Fix kinetics particle is above the boundary layer");
   return pos;
 }
 
+/* ----------------------------------------------------------------------
+ set up the exchange with the owners of the remote cells of local atoms,
+ given the owner and id of the cell of each atom with atom_cell[i] = -1,
+ and give those atoms their remote column
+ ------------------------------------------------------------------------- */
+void FixKinetics::setup_redist(std::vector<std::pair<int, int> > &remote) {
+  std::vector<std::pair<int, int> > cells(remote);
+  std::sort(cells.begin(), cells.end());
+  cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+  nremote = cells.size();
+
+  std::vector<int> procs(nremote), ids(nremote);
+  for (int s = 0; s < nremote; s++) {
+    procs[s] = cells[s].first;
+    ids[s] = cells[s].second;
+  }
+  redist.setup(world, procs, ids);
+
+  // the cells other procs import from us, as local columns
+  std::vector<int> &export_cells = redist.export_cells;
+  for (size_t k = 0; k < export_cells.size(); k++) {
+    int id = export_cells[k];
+    int c[3] = {id % nx - subnlo[0], (id / nx) % ny - subnlo[1], id / (nx * ny) - subnlo[2]};
+    export_cells[k] = cell_index(c);
+  }
+
+  if (ngrids + nremote > cell_nmax)
+    grow_cells(ngrids + nremote);
+
+  int k = 0;
+  for (int i = 0; i < atom->nlocal; i++) {
+    if (atom_cell[i] >= 0)
+      continue;
+    atom_cell[i] = ngrids + (std::lower_bound(cells.begin(), cells.end(), remote[k++]) - cells.begin());
+  }
+}
+
+/* ----------------------------------------------------------------------
+ grow xdensity and the growth rates to n columns
+ ------------------------------------------------------------------------- */
+void FixKinetics::grow_cells(int n) {
+  cell_nmax = n;
+  xdensity = memory->grow(xdensity, atom->ntypes + 1, n, "kinetics:xdensity");
+  if (energy != NULL)
+    energy->grow_subgrid(n);
+  if (monod != NULL)
+    monod->grow_subgrid(n);
+  if (matrix != NULL)
+    matrix->grow_subgrid(n);
+}
+
+/* ----------------------------------------------------------------------
+ copy the values of the remote cells of local atoms from their owners
+ into the per-grid arrays rows[0..nrows-1], a no-op unless decomp grid
+ ------------------------------------------------------------------------- */
+void FixKinetics::forward_cells(double **rows, int nrows) {
+  if (decomp == DECOMP_GRID)
+    redist.forward(world, rows, nrows, ngrids);
+}
+
+/* ----------------------------------------------------------------------
+ rebuild the cell list if atoms may have moved or changed since the
+ last binning, for callers outside integration()
+ ------------------------------------------------------------------------- */
+void FixKinetics::update_bins() {
+  if (bin_stamp != update->ntimestep || nbinned != atom->nlocal)
+    bin_atoms();
+}
+
 /* ----------------------------------------------------------------------
  reset nutrient reaction array
  ------------------------------------------------------------------------- */
@@ -560,6 +1298,75 @@ void FixKinetics::reset_nur() {
   }
 }
 
+/* ----------------------------------------------------------------------
+ store nutrient concentrations at a reaction evaluation
+ ------------------------------------------------------------------------- */
+void FixKinetics::save_nus_ref() {
+  for (int nu = 1; nu <= bio->nnu; nu++) {
+    for (int j = 0; j < bgrids; j++) {
+      nus_ref[nu][j] = nus[nu][j];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+ pack liquid nutrient concentrations, return the # of packed values
+ ------------------------------------------------------------------------- */
+int FixKinetics::pack_nus(double *buf) {
+  int n = 0;
+  for (int nu = 1; nu <= bio->nnu; nu++) {
+    if (bio->nustate[nu] != 0)
+      continue;
+    for (int j = 0; j < bgrids; j++) {
+      buf[n++] = nus[nu][j];
+    }
+  }
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+ unpack liquid nutrient concentrations packed by pack_nus()
+ ------------------------------------------------------------------------- */
+void FixKinetics::unpack_nus(const double *buf) {
+  int n = 0;
+  for (int nu = 1; nu <= bio->nnu; nu++) {
+    if (bio->nustate[nu] != 0)
+      continue;
+    for (int j = 0; j < bgrids; j++) {
+      nus[nu][j] = buf[n++];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+ largest change of a nutrient concentration since the last reaction
+ evaluation, relative to the largest concentration of that nutrient
+ ------------------------------------------------------------------------- */
+double FixKinetics::nus_change() {
+  int nnus = bio->nnu;
+
+  for (int nu = 1; nu <= nnus; nu++) {
+    double dmax = 0.0;
+    double rmax = 0.0;
+    for (int j = 0; j < bgrids; j++) {
+      dmax = MAX(dmax, fabs(nus[nu][j] - nus_ref[nu][j]));
+      rmax = MAX(rmax, fabs(nus_ref[nu][j]));
+    }
+    nus_change_max[2 * (nu - 1)] = dmax;
+    nus_change_max[2 * (nu - 1) + 1] = rmax;
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, nus_change_max, 2 * nnus, MPI_DOUBLE, MPI_MAX, world);
+
+  double change = 0.0;
+  for (int nu = 0; nu < nnus; nu++) {
+    if (nus_change_max[2 * nu + 1] > 0.0)
+      change = MAX(change, nus_change_max[2 * nu] / nus_change_max[2 * nu + 1]);
+  }
+
+  return change;
+}
+
 /* ----------------------------------------------------------------------
  reset convergence status
  ------------------------------------------------------------------------- */
@@ -578,6 +1385,40 @@ void FixKinetics::reset_isconv() {
   }
 }
 
+/* ----------------------------------------------------------------------
+   report the NUFEB phase timers at the end of a run
+------------------------------------------------------------------------- */
+
+void FixKinetics::post_run() {
+  bio->timer->report(memory_usage());
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of grid data, binning and solver work arrays
+------------------------------------------------------------------------- */
+
+double FixKinetics::memory_usage() {
+  int nnus = bio->nnu;
+  int ntypes = atom->ntypes;
+
+  double bytes = 0.0;
+  bytes += 2.0 * (nnus + 1) * ngrids * sizeof(double);           // nus, nur
+  bytes += (ntypes + 1) * cell_nmax * sizeof(double);            // xdensity
+  if (energy)                                                    // sh, activity, yield, gibbs
+    bytes += (1.0 + 5.0 * (nnus + 1) + 3.0 * (ntypes + 1)) * ngrids * sizeof(double);
+  if (nufebfoam)
+    bytes += 3.0 * ngrids * sizeof(double);                      // fv
+  if (nus_ref)
+    bytes += ((nnus + 1) * ngrids + 2.0 * nnus) * sizeof(double); // nus_ref, nus_change_max
+  bytes += (double)coupling_nmax * sizeof(double);
+  bytes += (double)mass_nmax * sizeof(double);
+  bytes += (double)skip_nmax * sizeof(double);
+  bytes += 2.0 * bin_nmax * sizeof(int) + (double)bin_ngrids * sizeof(int);
+  if (diffusion)
+    bytes += diffusion->memory_usage();
+  return bytes;
+}
+
 /* ---------------------------------------------------------------------- */
 int FixKinetics::modify_param(int narg, char **arg) {
   if (strcmp(arg[0], "demflag") == 0) {
@@ -608,7 +1449,10 @@ int FixKinetics::get_elem_per_cell() const {
 /* ---------------------------------------------------------------------- */
 
 void FixKinetics::migrate() {
-  Subgrid<double, 3> new_subgrid = Subgrid<double, 3>(grid, Box<double, 3>(domain->sublo, domain->subhi),
+  bio->timer->start(BioTimer::MIGRATE);
+  double lo[3], hi[3];
+  sub_box(lo, hi);
+  Subgrid<double, 3> new_subgrid = Subgrid<double, 3>(grid, Box<double, 3>(lo, hi),
       [](double value) {return std::round(value);});
   DecompGrid<FixKinetics>::migrate(grid, subgrid.get_box(), new_subgrid.get_box());
   for (int i = 0; i < 3; i++) {
@@ -620,6 +1464,9 @@ void FixKinetics::migrate() {
   }
   diffusion->migrate(grid, subgrid.get_box(), new_subgrid.get_box());
   subgrid = new_subgrid;
+  // resize() saw the old subdomain
+  trim_subgrid();
+  bio->timer->stop(BioTimer::MIGRATE);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -629,8 +1476,11 @@ void FixKinetics::resize(const Subgrid<double, 3> &subgrid) {
   int ntypes = atom->ntypes;
   ngrids = subgrid.cell_count();
   update_bgrids();
+  skip_valid = 0;
   nus = memory->grow(nus, nnus + 1, ngrids, "kinetics:nus");
   nur = memory->grow(nur, nnus + 1, ngrids, "kinetics:nur");
+  if (devery_auto)
+    nus_ref = memory->grow(nus_ref, nnus + 1, ngrids, "kinetics:nus_ref");
   if (energy) {
     grid_yield = memory->grow(grid_yield, ntypes + 1, ngrids, "kinetic:grid_yield");
     activity = memory->grow(activity, nnus + 1, 5, ngrids, "kinetics:activity");
@@ -641,8 +1491,15 @@ void FixKinetics::resize(const Subgrid<double, 3> &subgrid) {
   if (nufebfoam) {
     fv = memory->grow(fv, 3, ngrids, "kinetcis:fV");
   }
+  xdensity = memory->grow(xdensity, ntypes + 1, ngrids, "kinetics:xdensity");
+  if (energy != NULL)
+    energy->grow_subgrid(ngrids);
   if (monod != NULL)
     monod->grow_subgrid(ngrids);
+  if (matrix != NULL)
+    matrix->grow_subgrid(ngrids);
+  cell_nmax = ngrids;
+  nremote = 0;
   for (int i = 0; i < modify->ncompute; i++) {
     if (modify->compute[i]->style == "ave_height")
       static_cast<ComputeNufebHeight *>(modify->compute[i])->grow_subgrid();
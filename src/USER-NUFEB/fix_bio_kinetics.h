@@ -28,6 +28,7 @@ class FixKinetics : public Fix, public DecompGrid<FixKinetics> {
   friend class DecompGrid<FixKinetics>;
   friend class FixKineticsEnergy;
   friend class FixKineticsMonod;
+  friend class FixKineticsMatrix;
   friend class FixKineticsThermo;
   friend class FixKineticsDiffusion;
   friend class FixKineticsPH;
@@ -47,6 +48,8 @@ class FixKinetics : public Fix, public DecompGrid<FixKinetics> {
   void init();
   int modify_param(int, char **);
   void migrate();
+  void post_run();
+  double memory_usage();
 
   char **var;
   int *ivar;
@@ -77,11 +80,54 @@ class FixKinetics : public Fix, public DecompGrid<FixKinetics> {
   double maxheight;                // maximum biofilm height
   int niter;                       // # of iterations
   int devery;                      // # of steps to call ph, thermo and form calculations
+  int devery_auto;                 // 1 = re-evaluate reactions when nus has changed by more than devery_tol
+  double devery_tol;               // relative change of nus triggering a re-evaluation
+  int devery_min, devery_max;      // bounds on the # of steps between re-evaluations
+  double **nus_ref;                // nus at the last reaction evaluation [nutrient][grid]
+  double *nus_change_max;          // max change and max nus_ref of each nutrient [2 * nutrient]
+  int coupling;                    // reaction-diffusion coupling, PICARD, ANDERSON or JFNK
+  int anderson_m;                  // Anderson mixing depth
+  double *coupling_vec;            // liquid nus packed for the coupling solver [nutrient*grid]
+  int coupling_nmax;
+  int adapt_flag;                  // 1 = adapt the # of timesteps between biological steps
+  double adapt_safety;             // fraction of the doubling and depletion times allowed per step
+  int adapt_min, adapt_max;        // bounds on the # of timesteps between biological steps
+  int bio_nevery;                  // current # of timesteps between biological steps
+  bigint next_bio;                 // timestep of the next biological step when adapt_flag = 1
+  double *mass_prev;               // particle mass before the last growth step [nlocal]
+  int mass_nmax;
+  // solver statistics of the last biological step, see compute kinetics/stats
+  int stat_iter;                   // # of diffusion or Newton iterations
+  int stat_nevals;                 // # of reaction or residual evaluations
+  int *stat_conv;                  // iteration from which each nutrient stayed converged [nutrient]
+  int *stat_sweeps;                // # of diffusion sweeps of each nutrient [nutrient]
+  int counters_flag;               // 1 = sample hardware counters in the phase timers
+  long counters_fp;                // raw perf event code counted as FP ops, -1 if none
+
+  double skip_tol;                 // relative change of xdensity and nubs below which the solve is skipped
+  int nskip;                       // # of skipped steady-state solves
+  int skip_valid, skip_bgrids, skip_nmax;
+  double *xdensity_ref;            // overall density at the last steady-state solve [grid]
+  double *nubs_ref;                // bulk concentrations at the last steady-state solve [nutrient]
 
   int subn[3];                     // number of grids in x y axis for this proc
   int subnlo[3],subnhi[3];         // cell index of the subdomain lower and upper bound for each axis
   double sublo[3],subhi[3];        // subdomain lower and upper bound trimmed to the grid
 
+  int *atom_cell;                  // grid index of each local atom [nlocal]
+  int *cell_start;                 // first entry in cell_atoms of each grid [bgrids+1]
+  int *cell_atoms;                 // local atom indices sorted by grid [nlocal]
+  int nbinned;                     // # of atoms in the cell list
+  bigint bin_stamp;                // timestep of the last binning
+  int bin_nmax, bin_ngrids;        // allocated size of the binning arrays
+
+  int decomp;                      // ATOM = grid subdomains follow the particles, GRID = own partition
+  GridPartition partition;         // grid partition balanced by active cells with decomp grid
+  double block_thresh;             // imbalance of the block costs triggering a repartition, 0 = no blocks
+  GridRedist redist;               // exchange of cell values with the owners of remote cells
+  int nremote;                     // # of remote cells of local atoms, columns [ngrids, ngrids+nremote)
+  int cell_nmax;                   // allocated columns of xdensity and the growth rates
+
   Grid<double, 3> grid;
   Subgrid<double, 3> subgrid;
 
@@ -90,9 +136,12 @@ class FixKinetics : public Fix, public DecompGrid<FixKinetics> {
   class FixKineticsDiffusion *diffusion;
   class FixKineticsEnergy *energy;
   class FixKineticsMonod *monod;
+  class FixKineticsMatrix *matrix;
   class FixKineticsPH *ph;
   class FixKineticsThermo *thermo;
   class FixFluid *nufebfoam;
+  class AndersonMixer *anderson;
+  class NewtonKrylov *newton;
 
   //DINIKA - add for each fix kinetics
 
@@ -108,9 +157,29 @@ class FixKinetics : public Fix, public DecompGrid<FixKinetics> {
   void update_bgrids();
   void update_xdensity();
   bool is_inside(int);
-  int position(int);
+  void bin_atoms();
+  void update_bins();
+  int cell_index(const int *);
+  void setup_redist(std::vector<std::pair<int, int> > &);
+  void grow_cells(int);
+  void forward_cells(double **, int);
+  void sub_box(double *, double *);
+  void trim_subgrid();
+  bool repartition();
+  double block_profiles(std::vector<double> *);
+  const GridPartition *get_partition() const;
   void reset_nur();
+  bool bio_step();
+  void adapt_nevery();
+  void evaluate_reactions(double);
+  bool skip_solve();
+  void save_skip_ref();
+  void coupling_residual(const double *, double *, double);
   void reset_isconv();
+  void save_nus_ref();
+  int pack_nus(double *);
+  void unpack_nus(const double *);
+  double nus_change();
 
   Subgrid<double, 3> get_subgrid() const { return subgrid; }
   int get_elem_per_cell() const;
@@ -24,6 +24,7 @@
 #include "error.h"
 
 #include "bio.h"
+#include "bio_timer.h"
 #include "fix_bio_kinetics.h"
 #include "atom_vec_bio.h"
 #include "force.h"
@@ -45,6 +46,9 @@ using namespace std;
 enum{MOL, KG};
 enum{PP, DD, ND, NN, DN};
 enum{REGULAR, BOUNDARY, GHOST};
+enum{NORM_MAX, NORM_L2, NORM_FLUX};
+enum{TOL_ABS, TOL_REL};
+enum{HALO_PACK, HALO_PERSISTENT, HALO_SHARED};
 
 /* ---------------------------------------------------------------------- */
 
@@ -58,6 +62,15 @@ FixKineticsDiffusion::FixKineticsDiffusion(LAMMPS *lmp, int narg, char **arg) :
   bulkflag = 0;
   srate = 0;
   dcflag = 0;
+  normflag = NORM_MAX;
+  haloflag = HALO_PACK;
+  node_comm = MPI_COMM_NULL;
+  nugrid_win = MPI_WIN_NULL;
+  nugrid = NULL;
+  tol_abs = NULL;
+  tol_rel = NULL;
+  nures = NULL;
+  nusums = NULL;
 
   var = new char*[1];
   ivar = new int[1];
@@ -140,11 +153,54 @@ FixKineticsDiffusion::FixKineticsDiffusion(LAMMPS *lmp, int narg, char **arg) :
       if (af < 0)
         lmp->error->all(FLERR, "Biofilm surface area (Af) cannot be negative");
       iarg += 4;
+    } else if (strcmp(arg[iarg], "tol/abs") == 0 || strcmp(arg[iarg], "tol/rel") == 0) {
+      if (iarg + 3 > narg)
+        error->all(FLERR, "Illegal fix kinetics/diffusion command: tol/abs or tol/rel");
+      NutrientTol t;
+      t.kind = (strcmp(arg[iarg], "tol/abs") == 0) ? TOL_ABS : TOL_REL;
+      t.name = arg[iarg + 1];
+      t.value = force->numeric(FLERR, arg[iarg + 2]);
+      if (t.value < 0)
+        error->all(FLERR, "Illegal fix kinetics/diffusion command: tol/abs or tol/rel");
+      nutols.push_back(t);
+      iarg += 3;
+    } else if (strcmp(arg[iarg], "norm") == 0) {
+      if (iarg + 2 > narg)
+        error->all(FLERR, "Illegal fix kinetics/diffusion command: norm");
+      if (strcmp(arg[iarg + 1], "max") == 0)
+        normflag = NORM_MAX;
+      else if (strcmp(arg[iarg + 1], "l2") == 0)
+        normflag = NORM_L2;
+      else if (strcmp(arg[iarg + 1], "flux") == 0)
+        normflag = NORM_FLUX;
+      else
+        error->all(FLERR, "Illegal fix kinetics/diffusion command: norm");
+      iarg += 2;
+    } else if (strcmp(arg[iarg], "halo") == 0) {
+      if (iarg + 2 > narg)
+        error->all(FLERR, "Illegal fix kinetics/diffusion command: halo");
+      if (strcmp(arg[iarg + 1], "pack") == 0)
+        haloflag = HALO_PACK;
+      else if (strcmp(arg[iarg + 1], "persistent") == 0)
+        haloflag = HALO_PERSISTENT;
+      else if (strcmp(arg[iarg + 1], "shared") == 0)
+        haloflag = HALO_SHARED;
+      else
+        error->all(FLERR, "Illegal fix kinetics/diffusion command: halo");
+      iarg += 2;
     } else
       error->all(FLERR, "Illegal fix kinetics/diffusion command");
   }
   
   setup_exchange_flag = false;
+
+  if (haloflag == HALO_SHARED) {
+#if MPI_VERSION >= 3
+    MPI_Comm_split_type(world, MPI_COMM_TYPE_SHARED, comm->me, MPI_INFO_NULL, &node_comm);
+#else
+    error->all(FLERR, "Fix kinetics/diffusion halo shared requires MPI-3");
+#endif
+  }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -158,12 +214,19 @@ FixKineticsDiffusion::~FixKineticsDiffusion() {
   delete[] ivar;
 
   memory->destroy(xgrid);
-  memory->destroy(nugrid);
+  destroy_nugrid();
   memory->destroy(nuprev);
   memory->destroy(grid_diff_coeff);
   memory->destroy(ghost);
+  memory->destroy(tol_abs);
+  memory->destroy(tol_rel);
+  memory->destroy(nures);
+  memory->destroy(nusums);
 
   delete[] requests;
+
+  if (node_comm != MPI_COMM_NULL)
+    MPI_Comm_free(&node_comm);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -174,6 +237,22 @@ int FixKineticsDiffusion::setmask() {
   return mask;
 }
 
+/* ----------------------------------------------------------------------
+   memory usage of the ghost grids and halo exchange buffers
+------------------------------------------------------------------------- */
+
+double FixKineticsDiffusion::memory_usage() {
+  int nnus = bio->nnu;
+
+  double bytes = 0.0;
+  bytes += 3.0 * (nnus + 1) * snxx_yy_zz * sizeof(double);       // nugrid, nuprev, grid_diff_coeff
+  bytes += 3.0 * snxx_yy_zz * sizeof(double);                    // xgrid
+  bytes += (double)snxx_yy_zz * sizeof(int);                     // ghost
+  bytes += (double)buffer_size() * sizeof(double);
+  bytes += 4.0 * (nnus + 1) * sizeof(double);                    // nures, nusums
+  return bytes;
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FixKineticsDiffusion::init() {
@@ -210,6 +289,37 @@ void FixKineticsDiffusion::init() {
   bio = kinetics->bio;
   tol = input->variable->compute_equal(ivar[0]);
 
+  // per-nutrient tolerances, relative tolerance defaults to tol
+  memory->destroy(tol_abs);
+  memory->destroy(tol_rel);
+  memory->create(tol_abs, bio->nnu + 1, "diffusion:tol_abs");
+  memory->create(tol_rel, bio->nnu + 1, "diffusion:tol_rel");
+  memory->destroy(nures);
+  memory->create(nures, bio->nnu + 1, "diffusion:nures");
+  memory->destroy(nusums);
+  memory->create(nusums, 3 * (bio->nnu + 1), "diffusion:nusums");
+  for (int i = 0; i <= bio->nnu; i++) {
+    tol_abs[i] = 0.0;
+    tol_rel[i] = tol;
+    nures[i] = 0.0;
+  }
+  for (size_t k = 0; k < nutols.size(); k++) {
+    int found = 0;
+    for (int i = 1; i <= bio->nnu; i++) {
+      if (nutols[k].name == "all" || nutols[k].name == bio->nuname[i]) {
+        if (nutols[k].kind == TOL_ABS) tol_abs[i] = nutols[k].value;
+        else tol_rel[i] = nutols[k].value;
+        found = 1;
+      }
+    }
+    if (!found)
+      error->all(FLERR, "Unknown nutrient in fix kinetics/diffusion tol/abs or tol/rel");
+  }
+  for (int i = 1; i <= bio->nnu; i++) {
+    if (tol_abs[i] == 0.0 && tol_rel[i] == 0.0)
+      error->all(FLERR, "Fix kinetics/diffusion tolerances of a nutrient cannot all be zero");
+  }
+
   //set diffusion grid size
   nx = kinetics->nx;
   ny = kinetics->ny;
@@ -256,7 +366,7 @@ void FixKineticsDiffusion::init() {
   //inlet concentration and maximum boundary condition conc value
 
   xgrid = memory->create(xgrid, snxx_yy_zz, 3, "diffusion:xgrid");
-  nugrid = memory->create(nugrid, nnus + 1, snxx_yy_zz, "diffusion:nugrid");
+  create_nugrid(snxx_yy_zz);
   nuprev = memory->create(nuprev, nnus + 1, snxx_yy_zz, "diffusion:nuprev");
   ghost = memory->create(ghost, snxx_yy_zz, "diffusion:ghost");
   grid_diff_coeff = memory->create(grid_diff_coeff, nnus + 1, snxx_yy_zz, "diffusion:grid_diff_coeff");
@@ -266,46 +376,35 @@ void FixKineticsDiffusion::init() {
   // create request vector
   requests = new MPI_Request[MAX(2 * comm->nprocs, nnus + 1)];
 
-  setup_exchange(kinetics->grid, kinetics->subgrid.get_box(), { xbcflag == 0, ybcflag == 0, zbcflag == 0 });
+  reset_tree();
+  setup_halo(kinetics->grid, kinetics->subgrid.get_box());
 }
 
 /* ----------------------------------------------------------------------
  solve diffusion and reaction
  ------------------------------------------------------------------------- */
 
-int *FixKineticsDiffusion::diffusion(int *nuConv, int iter, double diff_dt) {
+int *FixKineticsDiffusion::diffusion(int *nuConv, double diff_dt) {
   int nnus = bio->nnu;
   this->diff_dt = diff_dt;
   double **nur = kinetics->nur;
   double **nus = kinetics->nus;
   double *nubs = kinetics->nubs;
-  double **ini_nus = bio->ini_nus;
 
   if (setup_exchange_flag)
   {
-    setup_exchange(kinetics->grid, kinetics->subgrid.get_box(), { xbcflag == 0, ybcflag == 0, zbcflag == 0 });
+    setup_halo(kinetics->grid, kinetics->subgrid.get_box());
     setup_exchange_flag = false;
   }
 
+  bio->timer->start(BioTimer::HALO);
   DecompGrid<FixKineticsDiffusion>::exchange();
+  bio->timer->stop(BioTimer::HALO);
 
+  bio->timer->start(BioTimer::DIFFUSION);
   for (int i = 1; i <= nnus; i++) {
     if (bio->nustate[i] == 0 && !nuConv[i]) {
-      if (unit == MOL) {
-        xbcm = ini_nus[i][1] * 1000;
-        xbcp = ini_nus[i][2] * 1000;
-        ybcm = ini_nus[i][3] * 1000;
-        ybcp = ini_nus[i][4] * 1000;
-        zbcm = ini_nus[i][5] * 1000;
-        zbcp = ini_nus[i][6] * 1000;
-      } else {
-        xbcm = ini_nus[i][1];
-        xbcp = ini_nus[i][2];
-        ybcm = ini_nus[i][3];
-        ybcp = ini_nus[i][4];
-        zbcm = ini_nus[i][5];
-        zbcp = ini_nus[i][6];
-      }
+      set_bc(i);
       // copy current concentrations
       for (int grid = 0; grid < snxx_yy_zz; grid++) {
         nuprev[i][grid] = nugrid[i][grid];
@@ -342,43 +441,168 @@ int *FixKineticsDiffusion::diffusion(int *nuConv, int iter, double diff_dt) {
       }
     }
   }
+  bio->timer->stop(BioTimer::DIFFUSION);
+
+  bio->timer->start(BioTimer::REDUCE);
+  if (normflag == NORM_MAX) {
+    int nrequests = 0;
+    for (int i = 1; i <= nnus; i++) {
+      // checking if is liquid
+      if (bio->nustate[i] == 0 && !nuConv[i]) {
+        // every grid must satisfy |new - prev| < tol_abs + tol_rel * |prev|
+        double max_residual = 0;
+
+        for (int grid = 0; grid < snxx_yy_zz; grid++) {
+          if (ghost[grid] == REGULAR) {
+            double scale = tol_abs[i] + tol_rel[i] * fabs(nuprev[i][grid]);
+            double residual = fabs(nugrid[i][grid] - nuprev[i][grid]) / scale;
+
+            if (residual > max_residual)
+              max_residual = residual;
+          }
+        }
 
-  int nrequests = 0;
-  for (int i = 1; i <= nnus; i++) {
-    // checking if is liquid
-    if (bio->nustate[i] == 0 && !nuConv[i]) {
-      // check convergence criteria
-      nuConv[i] = false;
-      double max_residual = 0;
+        nures[i] = max_residual;
+#if MPI_VERSION >= 3
+        MPI_Iallreduce(MPI_IN_PLACE, &nures[i], 1, MPI_DOUBLE, MPI_MAX, world, &requests[nrequests++]);
+#else
+        MPI_Allreduce(MPI_IN_PLACE, &nures[i], 1, MPI_DOUBLE, MPI_MAX, world);
+#endif
+      }
+    }
 
+#if MPI_VERSION >= 3
+    MPI_Waitall(nrequests, requests, MPI_STATUS_IGNORE);
+#endif
+
+    for (int i = 1; i <= nnus; i++) {
+      if (bio->nustate[i] == 0 && !nuConv[i])
+        nuConv[i] = nures[i] < 1.0;
+    }
+  } else {
+    // global sums per nutrient, reduced in one call
+    for (int i = 0; i < 3 * (nnus + 1); i++)
+      nusums[i] = 0.0;
+
+    for (int i = 1; i <= nnus; i++) {
+      if (bio->nustate[i] != 0 || nuConv[i])
+        continue;
       for (int grid = 0; grid < snxx_yy_zz; grid++) {
         if (ghost[grid] == REGULAR) {
-          double rate = nugrid[i][grid];
-          double prevRate = nuprev[i][grid];
-          double residual = fabs((nugrid[i][grid] - nuprev[i][grid]) / nuprev[i][grid]);
-
-          if (residual > max_residual)
-            max_residual = residual;
+          double change = nugrid[i][grid] - nuprev[i][grid];
+          if (normflag == NORM_L2) {
+            nusums[3 * i] += change * change;
+            nusums[3 * i + 1] += nuprev[i][grid] * nuprev[i][grid];
+            nusums[3 * i + 2] += 1.0;
+          } else {
+            int ind = get_index(grid);
+            double nur_ = (unit == KG) ? nur[i][ind] : nur[i][ind] * 1000;
+            nusums[3 * i] += fabs(change) / diff_dt;
+            nusums[3 * i + 1] += fabs(nur_);
+          }
         }
       }
+    }
 
-      if (max_residual < tol) nuConv[i] = true;
+    MPI_Allreduce(MPI_IN_PLACE, nusums, 3 * (nnus + 1), MPI_DOUBLE, MPI_SUM, world);
 
-#if MPI_VERSION >= 3
-      MPI_Iallreduce(MPI_IN_PLACE, &nuConv[i], 1, MPI_INT, MPI_BAND, world, &requests[nrequests++]);
-#else
-      MPI_Allreduce(MPI_IN_PLACE, &nuConv[i], 1, MPI_INT, MPI_BAND, world);
-#endif
+    for (int i = 1; i <= nnus; i++) {
+      if (bio->nustate[i] != 0 || nuConv[i])
+        continue;
+      if (normflag == NORM_L2) {
+        // root mean square change against the root mean square concentration
+        double n = MAX(nusums[3 * i + 2], 1.0);
+        nures[i] = sqrt(nusums[3 * i] / n) / (tol_abs[i] + tol_rel[i] * sqrt(nusums[3 * i + 1] / n));
+      } else {
+        // remaining rate of change against the total reaction rate, both
+        // summed over the grids and proportional to mass fluxes
+        nures[i] = nusums[3 * i] / (tol_abs[i] + tol_rel[i] * nusums[3 * i + 1]);
+      }
+      nuConv[i] = nures[i] < 1.0;
     }
   }
-
-#if MPI_VERSION >= 3
-  MPI_Waitall(nrequests, requests, MPI_STATUS_IGNORE);
-#endif
+  bio->timer->stop(BioTimer::REDUCE);
 
   return nuConv;
 }
 
+/* ----------------------------------------------------------------------
+ residual of the steady reaction-diffusion equations for the current
+ nugrid and nur, packed in the order of FixKinetics::pack_nus()
+ ------------------------------------------------------------------------- */
+
+void FixKineticsDiffusion::residual(double *res) {
+  int nnus = bio->nnu;
+  int bgrids = kinetics->bgrids;
+  double **nur = kinetics->nur;
+  double *nubs = kinetics->nubs;
+
+  if (setup_exchange_flag)
+  {
+    setup_halo(kinetics->grid, kinetics->subgrid.get_box());
+    setup_exchange_flag = false;
+  }
+
+  bio->timer->start(BioTimer::HALO);
+  DecompGrid<FixKineticsDiffusion>::exchange();
+  bio->timer->stop(BioTimer::HALO);
+
+  bio->timer->start(BioTimer::DIFFUSION);
+  int offset = 0;
+  for (int i = 1; i <= nnus; i++) {
+    if (bio->nustate[i] != 0)
+      continue;
+
+    set_bc(i);
+    double nubs_ = (unit == MOL) ? nubs[i] * 1000 : nubs[i];
+
+    for (int j = 0; j < bgrids; j++)
+      res[offset + j] = 0.0;
+
+    // boundary grids only depend on their regular neighbours
+    for (int grid = 0; grid < snxx_yy_zz; grid++) {
+      if (ghost[grid] == BOUNDARY)
+        compute_bc(nugrid[i][grid], nugrid[i], grid, nubs_);
+    }
+
+    for (int grid = 0; grid < snxx_yy_zz; grid++) {
+      if (ghost[grid] == REGULAR) {
+        int ind = get_index(grid);
+        double nur_ = (unit == KG) ? nur[i][ind] : nur[i][ind] * 1000;
+        double diff_coeff = dcflag ? grid_diff_coeff[i][grid] : bio->diff_coeff[i];
+
+        res[offset + ind] = compute_residual(diff_coeff, nugrid[i], nur_, grid, ind);
+      }
+    }
+    offset += bgrids;
+  }
+  bio->timer->stop(BioTimer::DIFFUSION);
+}
+
+/* ----------------------------------------------------------------------
+ set inlet boundary concentrations of nutrient i
+ ------------------------------------------------------------------------- */
+
+void FixKineticsDiffusion::set_bc(int i) {
+  double **ini_nus = bio->ini_nus;
+
+  if (unit == MOL) {
+    xbcm = ini_nus[i][1] * 1000;
+    xbcp = ini_nus[i][2] * 1000;
+    ybcm = ini_nus[i][3] * 1000;
+    ybcp = ini_nus[i][4] * 1000;
+    zbcm = ini_nus[i][5] * 1000;
+    zbcp = ini_nus[i][6] * 1000;
+  } else {
+    xbcm = ini_nus[i][1];
+    xbcp = ini_nus[i][2];
+    ybcm = ini_nus[i][3];
+    ybcp = ini_nus[i][4];
+    zbcm = ini_nus[i][5];
+    zbcp = ini_nus[i][6];
+  }
+}
+
 /* ----------------------------------------------------------------------
  Update grid concentration
   ------------------------------------------------------------------------- */
@@ -542,7 +766,7 @@ void FixKineticsDiffusion::compute_bulk() {
 
     MPI_Allreduce(&sumR, &global_sumR, 1, MPI_DOUBLE, MPI_SUM, world);
 
-    double dt = update->dt * kinetics->nevery;
+    double dt = update->dt * kinetics->bio_nevery;
     // solve for the mass balance in bulk liquid
     nubs_ = nubs_ + ((q / rvol) * (inibc - nubs_) + ((af * global_sumR * vol) / (rvol * yhi * xhi))) * dt;
 
@@ -688,6 +912,16 @@ void FixKineticsDiffusion::compute_bc(double &nuCell, double *nuPrev, int grid,
  ------------------------------------------------------------------------- */
 
 void FixKineticsDiffusion::compute_flux(double cellDNu, double &nuCell, double *nuPrev, double rateNu, int grid, int ind) {
+  //Updating the value: Ratesub*diffT + nuCell[cell](previous)
+  nuCell = nuPrev[grid] + compute_residual(cellDNu, nuPrev, rateNu, grid, ind) * diff_dt;
+}
+
+/* ----------------------------------------------------------------------
+ time derivative of the concentration in a non-ghost grid: fluxes in all
+ directions, advection or shear and the uptake rate
+ ------------------------------------------------------------------------- */
+
+double FixKineticsDiffusion::compute_residual(double cellDNu, double *nuPrev, double rateNu, int grid, int ind) {
   int lhs = grid - 1;   // x direction
   int rhs = grid + 1;  // x direction
   int bwd = grid - snxx;  // y direction
@@ -734,8 +968,7 @@ void FixKineticsDiffusion::compute_flux(double cellDNu, double &nuCell, double *
     res -= shear;
   }
 
-  //Updating the value: Ratesub*diffT + nuCell[cell](previous)
-  nuCell = nuPrev[grid] + res * diff_dt;
+  return res;
 }
 
 /* ----------------------------------------------------------------------
@@ -767,7 +1000,7 @@ void FixKineticsDiffusion::update_nus() {
         // transform nXYZ index to nuR index
         if (!ghost[grid]) {
           int ind = get_index(grid);
-          int dt = update->dt * kinetics->nevery;
+          int dt = update->dt * kinetics->bio_nevery;
           double r = (unit == KG) ? nur[nu][ind] * dt : nur[nu][ind] * dt * 1000;
 
           nugrid[nu][grid] += r;
@@ -782,15 +1015,94 @@ void FixKineticsDiffusion::update_nus() {
   }
 }
 
+/* ----------------------------------------------------------------------
+ copy nus back into the regular grids after it was changed outside
+ the diffusion solver
+ ------------------------------------------------------------------------- */
+
+void FixKineticsDiffusion::restore_nugrid() {
+  double **nus = kinetics->nus;
+
+  for (int nu = 1; nu <= bio->nnu; nu++) {
+    if (bio->nustate[nu] != 0)
+      continue;
+
+    for (int grid = 0; grid < snxx_yy_zz; grid++) {
+      if (ghost[grid] == REGULAR) {
+        int ind = get_index(grid);
+        if (nus[nu][ind] <= 0)
+          nus[nu][ind] = 1e-20;
+        nugrid[nu][grid] = (unit == KG) ? nus[nu][ind] : nus[nu][ind] * 1000;
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+ set up the halo exchange of nugrid for the given subgrid box
+ ------------------------------------------------------------------------- */
+
+void FixKineticsDiffusion::setup_halo(const Grid<double, 3> &grid, const Box<int, 3> &box) {
+  setup_exchange(grid, box, { xbcflag == 0, ybcflag == 0, zbcflag == 0 });
+  if (haloflag == HALO_PERSISTENT)
+    setup_persistent(nugrid);
+#if MPI_VERSION >= 3
+  else if (haloflag == HALO_SHARED)
+    setup_shared(node_comm, nugrid_win, nugrid);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+ (re)allocate nugrid for n grids, in a window shared by the ranks of the
+ node with halo shared; the content is not preserved in that case
+ ------------------------------------------------------------------------- */
+
+void FixKineticsDiffusion::create_nugrid(int n) {
+  int nnus = bio->nnu;
+  if (haloflag != HALO_SHARED) {
+    nugrid = memory->grow(nugrid, nnus + 1, n, "diffusion:nugrid");
+    return;
+  }
+#if MPI_VERSION >= 3
+  destroy_nugrid();
+  double *data;
+  MPI_Win_allocate_shared((MPI_Aint) (nnus + 1) * n * sizeof(double), sizeof(double),
+                          MPI_INFO_NULL, node_comm, &data, &nugrid_win);
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, nugrid_win);
+  nugrid = (double **) memory->smalloc((nnus + 1) * sizeof(double *), "diffusion:nugrid");
+  for (int i = 0; i <= nnus; i++)
+    nugrid[i] = &data[i * n];
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsDiffusion::destroy_nugrid() {
+  if (nugrid_win == MPI_WIN_NULL) {
+    memory->destroy(nugrid);
+    return;
+  }
+#if MPI_VERSION >= 3
+  MPI_Win_unlock_all(nugrid_win);
+  MPI_Win_free(&nugrid_win);
+#endif
+  memory->sfree(nugrid);
+  nugrid = NULL;
+}
+
 int FixKineticsDiffusion::get_elem_per_cell() const {
   return bio->nnu;
 }
 
+const GridPartition *FixKineticsDiffusion::get_partition() const {
+  return kinetics->get_partition();
+}
+
 void FixKineticsDiffusion::resize(const Subgrid<double, 3> &subgrid) {
   int nnus = bio->nnu;
   snxx_yy_zz = subgrid.cell_count();
   xgrid = memory->grow(xgrid, snxx_yy_zz, 3, "diffusion:xGrid");
-  nugrid = memory->grow(nugrid, nnus + 1, snxx_yy_zz, "diffusion:nuGrid");
+  create_nugrid(snxx_yy_zz);
   nuprev = memory->grow(nuprev, nnus + 1, snxx_yy_zz, "diffusion:nuPrev");
   ghost = memory->grow(ghost, snxx_yy_zz, "diffusion:ghost");
 }
@@ -798,7 +1110,7 @@ void FixKineticsDiffusion::resize(const Subgrid<double, 3> &subgrid) {
 void FixKineticsDiffusion::migrate(const Grid<double, 3> &grid, const Box<int, 3> &from, const Box<int, 3> &to) {
   DecompGrid<FixKineticsDiffusion>::migrate(grid, from, to, extend(from), extend(to));
   Subgrid<double, 3> subgrid(grid, to);
-  setup_exchange(grid, to, { xbcflag == 0, ybcflag == 0, zbcflag == 0 });
+  setup_halo(grid, to);
   Subgrid<double, 3> extended(kinetics->grid, extend(to));
   auto cell_centers = extended.get_cell_centers();
   for (int i = 0; i < extended.cell_count(); i++) {
@@ -21,6 +21,10 @@ FixStyle(kinetics/diffusion,FixKineticsDiffusion)
 #include "bio.h"
 #include "fix.h"
 #include "decomp_grid.h"
+#include "kinetics_dispatch.h"
+
+#include <string>
+#include <vector>
 
 namespace LAMMPS_NS {
 class AtomVecBio;
@@ -52,6 +56,14 @@ public:
 
   double srate;                           // shear rate
   double tol;                             // tolerance for convergence criteria
+  double *tol_abs;                        // absolute tolerance [nutrient]
+  double *tol_rel;                        // relative tolerance [nutrient], defaults to tol
+  int normflag;                           // convergence norm, 0=max, 1=l2, 2=mass flux
+  double *nures;                          // last residual over tolerance [nutrient], < 1 when converged
+  double *nusums;                         // per-nutrient sums of the l2 and flux norms [3 * nutrient]
+  int haloflag;                           // halo exchange, 0=pack into buffers, 1=persistent requests in place, 2=shared memory on node
+  MPI_Comm node_comm;                     // ranks sharing memory with this one when haloflag = 2
+  MPI_Win nugrid_win;                     // shared window holding nugrid when haloflag = 2
 
   double **nugrid;                        // nutrient concentration in ghost grid [nutrient][grid], unit in mol or kg/m3
   double **xgrid;                         // grid coordinate [gird][3]
@@ -79,12 +91,21 @@ public:
   FixKinetics *kinetics;
   AtomVecBio *avec;
 
+  struct NutrientTol {
+    int kind;                             // absolute or relative
+    std::string name;                     // nutrient name or all
+    double value;
+  };
+  std::vector<NutrientTol> nutols;        // tolerances given in the input
+
   bool setup_exchange_flag; // flags that setup_exchange needs to be called in the next call to diffusion
   
   int setmask();
   void init();
-  int *diffusion(int*, int, double);
+  double memory_usage();
+  int *diffusion(int*, double);
   void update_nus();
+  void restore_nugrid();
   void update_grids();
   void update_diff_coeff();
   void init_grid();
@@ -92,25 +113,52 @@ public:
   void compute_bulk();
   void compute_blayer();
   void compute_flux(double, double &, double *, double, int, int);
+  double compute_residual(double, double *, double, int, int);
+  void residual(double *);
+  void set_bc(int);
 
   bool is_equal(double, double, double);
   int get_index(int);
   void migrate(const Grid<double, 3> &, const Box<int, 3> &, const Box<int, 3> &);
+  void setup_halo(const Grid<double, 3> &, const Box<int, 3> &);
+  void create_nugrid(int);
+  void destroy_nugrid();
 
   int get_elem_per_cell() const;
+  const GridPartition *get_partition() const;
   template<typename InputIterator, typename OutputIterator>
   OutputIterator pack_cells(InputIterator first, InputIterator last, OutputIterator result) {
+#define PACK_CASE(N) case N: return pack_cells_n<N>(first, last, result);
+    switch (bio->nnu) {
+    NUFEB_NNU_CASES(PACK_CASE)
+    default: return pack_cells_n<0>(first, last, result);
+    }
+#undef PACK_CASE
+  }
+  template<typename InputIterator0, typename InputIterator1>
+  InputIterator1 unpack_cells(InputIterator0 first, InputIterator0 last, InputIterator1 input) {
+#define UNPACK_CASE(N) case N: return unpack_cells_n<N>(first, last, input);
+    switch (bio->nnu) {
+    NUFEB_NNU_CASES(UNPACK_CASE)
+    default: return unpack_cells_n<0>(first, last, input);
+    }
+#undef UNPACK_CASE
+  }
+  template<int NNU, typename InputIterator, typename OutputIterator>
+  OutputIterator pack_cells_n(InputIterator first, InputIterator last, OutputIterator result) {
+    const int nnu = NNU > 0 ? NNU : bio->nnu;
     for (InputIterator it = first; it != last; ++it) {
-      for (int i = 1; i <= bio->nnu; i++) {
+      for (int i = 1; i <= nnu; i++) {
         *result++ = nugrid[i][*it];
       }
     }
     return result;
   }
-  template<typename InputIterator0, typename InputIterator1>
-  InputIterator1 unpack_cells(InputIterator0 first, InputIterator0 last, InputIterator1 input) {
+  template<int NNU, typename InputIterator0, typename InputIterator1>
+  InputIterator1 unpack_cells_n(InputIterator0 first, InputIterator0 last, InputIterator1 input) {
+    const int nnu = NNU > 0 ? NNU : bio->nnu;
     for (InputIterator0 it = first; it != last; ++it) {
-      for (int i = 1; i <= bio->nnu; i++) {
+      for (int i = 1; i <= nnu; i++) {
         nugrid[i][*it] = *input++;
       }
     }
@@ -30,7 +30,9 @@
 #include "memory.h"
 
 #include "bio.h"
+#include "biomass_update.h"
 #include "fix_bio_kinetics.h"
+#include "kinetics_dispatch.h"
 #include "modify.h"
 #include "pointers.h"
 #include "update.h"
@@ -52,6 +54,8 @@ FixKineticsEnergy::FixKineticsEnergy(LAMMPS *lmp, int narg, char **arg) :
   if (!avec)
     error->all(FLERR, "Fix kinetics requires atom style bio");
 
+  biomass = new BiomassUpdate(lmp);
+
   if (narg != 4)
     error->all(FLERR, "Not enough arguments in fix kinetics/monod command");
 
@@ -71,6 +75,7 @@ FixKineticsEnergy::FixKineticsEnergy(LAMMPS *lmp, int narg, char **arg) :
 /* ---------------------------------------------------------------------- */
 
 FixKineticsEnergy::~FixKineticsEnergy() {
+  delete biomass;
   int i;
   for (i = 0; i < 1; i++) {
     delete[] var[i];
@@ -167,26 +172,55 @@ void FixKineticsEnergy::init() {
   stepz = (zhi - zlo) / nz;
 
   vol = stepx * stepy * stepz;
+
+#define ENERGY_CASE(N) case N: growth_fn = &FixKineticsEnergy::growth_n<N>; break;
+
+  switch (bio->nnu) {
+  NUFEB_NNU_CASES(ENERGY_CASE)
+  default:
+    growth_fn = &FixKineticsEnergy::growth_n<0>;
+  }
+
+#undef ENERGY_CASE
 }
 
 /* ----------------------------------------------------------------------
  metabolism and atom update
  ------------------------------------------------------------------------- */
 void FixKineticsEnergy::growth(double dt, int gflag) {
+  (this->*growth_fn)(dt, gflag);
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int NNU>
+void FixKineticsEnergy::growth_n(double dt, int gflag) {
+  const int nnu = NNU > 0 ? NNU : bio->nnu;
   int ntypes = atom->ntypes;
 
   double **cata_coeff = bio->cata_coeff;
   double **anab_coeff = bio->anab_coeff;
+  double **decay_coeff = bio->decay_coeff;
   double *maintain = bio->maintain;
   double *decay = bio->decay;
+  int *nustate = bio->nustate;
 
   double **nur = kinetics->nur;
-  int nnu = bio->nnu;
 
   double **grid_yield = kinetics->grid_yield;
   double **xdensity = kinetics->xdensity;
   int *nuconv = kinetics->nuconv;
 
+  // growrate is only set when there is at least one liquid nutrient
+  bool liquid = false;
+  for (int nu = 1; nu <= nnu; nu++)
+    if (nustate[nu] == 0) liquid = true;
+
+  // grids are independent, each thread owns the nur and growrate entries
+  // of its grids
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
   for (int grid = 0; grid < kinetics->bgrids; grid++) {
     //empty grid is not considered
     if(!xdensity[0][grid]) continue;
@@ -194,7 +228,7 @@ void FixKineticsEnergy::growth(double dt, int gflag) {
     for (int t = 1; t <= ntypes; t++) {
       double qmet, maint, inv_yield;
 
-      qmet = bio->q[t] * grid_monod(t, grid);
+      qmet = bio->q[t] * grid_monod_n<NNU>(t, grid);
 
       if (!kinetics->gibbs_cata[t][grid]) maint = 0;
       else maint = maintain[t] / -kinetics->gibbs_cata[t][grid];
@@ -202,28 +236,38 @@ void FixKineticsEnergy::growth(double dt, int gflag) {
       if (grid_yield[t][grid]) inv_yield = 1 / grid_yield[t][grid];
       else inv_yield = 0;
 
-      for (int nu = 1; nu <= nnu; nu++) {
-        if (bio->nustate[nu] != 0) continue;
-        //microbe growth
-        if (1.2 * maint < qmet) {
+      const double yield = grid_yield[t][grid];
+      const double x = xdensity[t][grid];
+
+      //microbe growth
+      if (1.2 * maint < qmet) {
+        double gr = yield * (qmet - maint);
+        if (liquid) growrate[t][grid] = gr;
+        for (int nu = 1; nu <= nnu; nu++) {
+          if (nustate[nu] != 0) continue;
           double metCoeff = cata_coeff[t][nu] * inv_yield + anab_coeff[t][nu];
-          growrate[t][grid] = grid_yield[t][grid] * (qmet - maint);
           // reaction in mol/m3
-          if(!nuconv[nu]) nur[nu][grid] += growrate[t][grid] * xdensity[t][grid] * metCoeff / 24.6;
-        //microbe maintenance
-        } else if (qmet <= 1.2 * maint && maint <= qmet) {
-          growrate[t][grid] = 0;
-          if(!nuconv[nu]) nur[nu][grid] += cata_coeff[t][nu] * grid_yield[t][grid] * qmet * xdensity[t][grid] / 24.6;
-        //microbe decay
-        } else {
-          double f;
-          if (maint == 0) f = 0;
-          else f = (maint - qmet) / maint;
-
-          growrate[t][grid] = -decay[t] * f;
-
-          if(!nuconv[nu]) nur[nu][grid] += (-growrate[t][grid] * bio->decay_coeff[t][nu] +
-              cata_coeff[t][nu] * grid_yield[t][grid] * qmet) * xdensity[t][grid] / 24.6;
+          if(!nuconv[nu]) nur[nu][grid] += gr * x * metCoeff / 24.6;
+        }
+      //microbe maintenance
+      } else if (qmet <= 1.2 * maint && maint <= qmet) {
+        if (liquid) growrate[t][grid] = 0;
+        for (int nu = 1; nu <= nnu; nu++) {
+          if (nustate[nu] != 0) continue;
+          if(!nuconv[nu]) nur[nu][grid] += cata_coeff[t][nu] * yield * qmet * x / 24.6;
+        }
+      //microbe decay
+      } else {
+        double f;
+        if (maint == 0) f = 0;
+        else f = (maint - qmet) / maint;
+
+        double gr = -decay[t] * f;
+        if (liquid) growrate[t][grid] = gr;
+        for (int nu = 1; nu <= nnu; nu++) {
+          if (nustate[nu] != 0) continue;
+          if(!nuconv[nu]) nur[nu][grid] += (-gr * decay_coeff[t][nu] +
+              cata_coeff[t][nu] * yield * qmet) * x / 24.6;
         }
       }
     }
@@ -232,6 +276,12 @@ void FixKineticsEnergy::growth(double dt, int gflag) {
   if (gflag) update_biomass(growrate, dt);
 }
 
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsEnergy::grow_subgrid(int n) {
+  growrate = memory->grow(growrate, atom->ntypes + 1, n, "energy:growrate");
+}
+
 /* ----------------------------------------------------------------------
  update particle attributes: biomass, outer mass, radius etc
  ------------------------------------------------------------------------- */
@@ -239,43 +289,35 @@ void FixKineticsEnergy::update_biomass(double **growrate, double dt) {
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
   int *type = atom->type;
+  int *atom_cell = kinetics->atom_cell;
 
-  double *radius = atom->radius;
-  double *rmass = atom->rmass;
-  double *outer_mass = avec->outer_mass;
-  double *outer_radius = avec->outer_radius;
+  // growth rates of the cells of local atoms owned by other procs
+  kinetics->forward_cells(growrate, atom->ntypes + 1);
 
-  const double three_quarters_pi = (3.0 / (4.0 * MY_PI));
-  const double four_thirds_pi = 4.0 * MY_PI / 3.0;
-  const double third = 1.0 / 3.0;
+  biomass->reserve(nlocal);
+  int *mode = biomass->mode;
+  double *grow = biomass->grow;
+  double *eps = biomass->eps;
+
+  // HET radius, and EPS shell if EPS production is on; EPS and dead
+  // particles gain mass but keep their radius
+  int het = epsflag == 1 ? BiomassUpdate::SHELL_GROWN : BiomassUpdate::CORE;
 
   for (int i = 0; i < nlocal; i++) {
     int t = type[i];
-    int pos = kinetics->position(i);
-
-    double density = rmass[i] / (four_thirds_pi * radius[i] * radius[i] * radius[i]);
-    rmass[i] = rmass[i] * (1 + growrate[t][pos] * dt);
-
-
-    //update mass and radius
-    if (mask[i] == avec->mask_het) {
-      //update HET radius
-      radius[i] = pow(three_quarters_pi * (rmass[i] / density), third);
-      //update mass and radius for EPS shell if PES production is on
-      //TODO
-      if (epsflag == 1) {
-        outer_mass[i] = four_thirds_pi * (outer_radius[i] * outer_radius[i] * outer_radius[i] - radius[i] * radius[i] * radius[i])
-            * eps_dens + growrate[t][pos] * rmass[i];
-
-        outer_radius[i] = pow(three_quarters_pi * (rmass[i] / density + outer_mass[i] / eps_dens), third);
-        radius[i] = pow(three_quarters_pi * (rmass[i] / density), third);
-      }
-    } else if (mask[i] != avec->eps_mask && mask[i] != avec->mask_dead) {
-      radius[i] = pow(three_quarters_pi * (rmass[i] / density), third);
-      outer_mass[i] = rmass[i];
-      outer_radius[i] = radius[i];
-    }
+    int pos = atom_cell[i];
+
+    grow[i] = growrate[t][pos] * dt;
+    eps[i] = growrate[t][pos];
+    if (mask[i] == avec->mask_het)
+      mode[i] = het;
+    else if (mask[i] != avec->eps_mask && mask[i] != avec->mask_dead)
+      mode[i] = BiomassUpdate::PLAIN;
+    else
+      mode[i] = BiomassUpdate::FIXED;
   }
+
+  biomass->apply(nlocal, eps_dens);
 }
 
 /* ----------------------------------------------------------------------
@@ -283,9 +325,17 @@ void FixKineticsEnergy::update_biomass(double **growrate, double dt) {
  ------------------------------------------------------------------------- */
 
 double FixKineticsEnergy::grid_monod(int type, int grid) {
+  return grid_monod_n<0>(type, grid);
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int NNU>
+double FixKineticsEnergy::grid_monod_n(int type, int grid) {
+  const int nnu = NNU > 0 ? NNU : bio->nnu;
   double monod = 1;
 
-  for (int i = 1; i <= bio->nnu; i++) {
+  for (int i = 1; i <= nnu; i++) {
     int flag = bio->ngflag[i];
     double s = kinetics->activity[i][flag][grid];
     double ks = bio->ks[type][i];
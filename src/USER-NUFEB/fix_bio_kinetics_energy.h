@@ -29,6 +29,7 @@ class FixKineticsEnergy : public Fix {
   void init();
   int setmask();
   void growth(double, int);
+  void grow_subgrid(int);
 
   double **growrate;
 
@@ -45,12 +46,19 @@ class FixKineticsEnergy : public Fix {
   int epsflag;                      // EPS flag
 
   class AtomVecBio *avec;
+  class BiomassUpdate *biomass;
   class FixKinetics *kinetics;
   class BIO *bio;
 
  // double minimal_monod(int, int, int);
   double grid_monod(int, int);
   void update_biomass(double**, double);
+
+  // growth kernel specialised on the number of nutrients, selected in init()
+  void (FixKineticsEnergy::*growth_fn)(double, int);
+
+  template <int NNU> void growth_n(double, int);
+  template <int NNU> double grid_monod_n(int, int);
 };
 
 }
@@ -0,0 +1,767 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atom.h"
+#include "atom_vec_bio.h"
+#include "error.h"
+#include "force.h"
+#include "input.h"
+#include "math_const.h"
+#include "memory.h"
+#include "modify.h"
+#include "variable.h"
+
+#include "bio.h"
+#include "biomass_update.h"
+#include "fix_bio_kinetics.h"
+#include "fix_bio_kinetics_matrix.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+using namespace MathConst;
+
+// bytecode opcodes, the C suffix denotes a constant right operand
+// and the R prefix a constant left operand
+enum {LOADNU, LOADX, CONST, SWAP, NEG, EXP, LOG, SQRT,
+      ADD, SUB, MUL, DIV, POW, FMIN, FMAX, MONOD, INHIB,
+      ADDC, RSUBC, MULC, DIVC, RDIVC, POWC, RPOWC, FMINC, FMAXC,
+      MONODC, INHIBC};
+
+#define MATRIX_BLOCK 256
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsMatrix::FixKineticsMatrix(LAMMPS *lmp, int narg, char **arg) :
+    Fix(lmp, narg, arg) {
+  avec = (AtomVecBio *) atom->style_match("bio");
+  if (!avec)
+    error->all(FLERR, "Fix kinetics requires atom style bio");
+
+  biomass = new BiomassUpdate(lmp);
+
+  kinetics = NULL;
+  bio = NULL;
+  var = NULL;
+  ivar = -1;
+  eps_dens = 0;
+  external_gflag = 1;
+
+  nu_start = NULL;
+  nu_index = NULL;
+  nu_coeff = NULL;
+  grow_coeff = NULL;
+  epsflag = NULL;
+  growrate = NULL;
+  stack = NULL;
+  max_depth = 0;
+
+  int iarg = 3;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg], "const") == 0) {
+      if (iarg + 3 > narg)
+        error->all(FLERR, "Illegal fix kinetics/growth/matrix command: const");
+      Const c;
+      c.name = arg[iarg+1];
+      c.value = arg[iarg+2];
+      c.c = 0;
+      consts.push_back(c);
+      iarg += 3;
+    } else if (strcmp(arg[iarg], "rate") == 0) {
+      if (iarg + 4 > narg)
+        error->all(FLERR, "Illegal fix kinetics/growth/matrix command: rate");
+      Process p;
+      p.name = arg[iarg+1];
+      p.tname = arg[iarg+2];
+      p.expr = arg[iarg+3];
+      p.type = 0;
+      p.depth = 0;
+      procs.push_back(p);
+      iarg += 4;
+    } else if (strcmp(arg[iarg], "nu") == 0) {
+      if (iarg + 4 > narg)
+        error->all(FLERR, "Illegal fix kinetics/growth/matrix command: nu");
+      Entry e;
+      e.process = arg[iarg+1];
+      e.target = arg[iarg+2];
+      e.coeff = force->numeric(FLERR, arg[iarg+3]);
+      nu_entries.push_back(e);
+      iarg += 4;
+    } else if (strcmp(arg[iarg], "growth") == 0 || strcmp(arg[iarg], "eps") == 0) {
+      if (iarg + 3 > narg)
+        error->all(FLERR, "Illegal fix kinetics/growth/matrix command: growth");
+      Entry e;
+      e.process = arg[iarg+1];
+      e.coeff = force->numeric(FLERR, arg[iarg+2]);
+      if (arg[iarg][0] == 'g') growth_entries.push_back(e);
+      else eps_entries.push_back(e);
+      iarg += 3;
+    } else if (strcmp(arg[iarg], "epsdens") == 0) {
+      if (iarg + 2 > narg || strncmp(arg[iarg+1], "v_", 2) != 0)
+        error->all(FLERR, "Illegal fix kinetics/growth/matrix command: epsdens");
+      int n = strlen(&arg[iarg+1][2]) + 1;
+      var = new char[n];
+      strcpy(var, &arg[iarg+1][2]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg], "gflag") == 0) {
+      if (iarg + 2 > narg)
+        error->all(FLERR, "Illegal fix kinetics/growth/matrix command: gflag");
+      external_gflag = force->inumeric(FLERR, arg[iarg+1]);
+      if (external_gflag != 0 && external_gflag != 1)
+        error->all(FLERR, "Illegal fix kinetics/growth/matrix command: gflag");
+      iarg += 2;
+    } else
+      error->all(FLERR, "Illegal fix kinetics/growth/matrix command");
+  }
+
+  if (procs.empty())
+    error->all(FLERR, "Fix kinetics/growth/matrix requires at least one rate");
+  if (!eps_entries.empty() && var == NULL)
+    error->all(FLERR, "Fix kinetics/growth/matrix requires epsdens when eps is used");
+
+  for (size_t i = 0; i < procs.size(); i++)
+    for (size_t j = 0; j < i; j++)
+      if (procs[i].name == procs[j].name)
+        error->all(FLERR, "Duplicate process name in fix kinetics/growth/matrix");
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsMatrix::~FixKineticsMatrix() {
+  delete biomass;
+  delete[] var;
+
+  memory->destroy(nu_start);
+  memory->destroy(nu_index);
+  memory->destroy(nu_coeff);
+  memory->destroy(grow_coeff);
+  memory->destroy(epsflag);
+  memory->destroy(growrate);
+  memory->destroy(stack);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixKineticsMatrix::setmask() {
+  int mask = 0;
+  mask |= PRE_FORCE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsMatrix::init() {
+  if (!atom->radius_flag)
+    error->all(FLERR, "Fix requires atom attribute diameter");
+
+  // register fix kinetics with this class
+  kinetics = NULL;
+
+  int nfix = modify->nfix;
+  for (int j = 0; j < nfix; j++) {
+    if (strcmp(modify->fix[j]->style, "kinetics") == 0) {
+      kinetics = static_cast<FixKinetics *>(lmp->modify->fix[j]);
+      break;
+    }
+  }
+
+  if (kinetics == NULL)
+    lmp->error->all(FLERR, "fix kinetics command is required for running IbM simulation");
+
+  bio = kinetics->bio;
+
+  if (bio->nnu == 0)
+    error->all(FLERR, "fix_kinetics/matrix requires Nutrients input");
+
+  if (var != NULL) {
+    ivar = input->variable->find(var);
+    if (ivar < 0)
+      error->all(FLERR, "Variable name for fix kinetics/growth/matrix does not exist");
+    if (!input->variable->equalstyle(ivar))
+      error->all(FLERR, "Variable for fix kinetics/growth/matrix is invalid style");
+    eps_dens = input->variable->compute_equal(ivar);
+  }
+
+  compile();
+
+  memory->destroy(growrate);
+  growrate = memory->create(growrate, atom->ntypes + 1, 2, kinetics->ngrids, "matrix:growrate");
+}
+
+/* ----------------------------------------------------------------------
+ resolve names, build the stoichiometric matrix and compile rate expressions
+ ------------------------------------------------------------------------- */
+void FixKineticsMatrix::compile() {
+  int nprocs = procs.size();
+  int ntypes = atom->ntypes;
+
+  // constants are evaluated once per run
+  for (size_t i = 0; i < consts.size(); i++) {
+    const char *value = consts[i].value.c_str();
+    if (strncmp(value, "v_", 2) == 0) {
+      int jvar = input->variable->find((char *) &value[2]);
+      if (jvar < 0)
+        error->all(FLERR, "Variable name for fix kinetics/growth/matrix does not exist");
+      if (!input->variable->equalstyle(jvar))
+        error->all(FLERR, "Variable for fix kinetics/growth/matrix is invalid style");
+      consts[i].c = input->variable->compute_equal(jvar);
+    } else {
+      consts[i].c = force->numeric(FLERR, (char *) value);
+    }
+  }
+
+  for (int p = 0; p < nprocs; p++) {
+    procs[p].type = 0;
+    for (int t = 1; t <= ntypes; t++) {
+      if (bio->tname[t] && procs[p].tname == bio->tname[t]) {
+        procs[p].type = t;
+        break;
+      }
+    }
+    if (procs[p].type == 0)
+      error->all(FLERR, "Unknown type name in fix kinetics/growth/matrix rate");
+  }
+
+  // sort nutrient entries into rows
+  memory->destroy(nu_start);
+  memory->destroy(nu_index);
+  memory->destroy(nu_coeff);
+  memory->destroy(grow_coeff);
+  memory->destroy(epsflag);
+
+  int nentries = nu_entries.size();
+  nu_start = memory->create(nu_start, nprocs + 1, "matrix:nu_start");
+  nu_index = memory->create(nu_index, MAX(nentries, 1), "matrix:nu_index");
+  nu_coeff = memory->create(nu_coeff, MAX(nentries, 1), "matrix:nu_coeff");
+  grow_coeff = memory->create(grow_coeff, nprocs, 2, "matrix:grow_coeff");
+  epsflag = memory->create(epsflag, ntypes + 1, "matrix:epsflag");
+
+  for (int t = 0; t <= ntypes; t++)
+    epsflag[t] = 0;
+
+  int n = 0;
+  for (int p = 0; p < nprocs; p++) {
+    nu_start[p] = n;
+    for (int k = 0; k < nentries; k++) {
+      if (find_process(nu_entries[k].process) != p) continue;
+      int nu = 0;
+      for (int i = 1; i <= bio->nnu; i++) {
+        if (nu_entries[k].target == bio->nuname[i]) {
+          nu = i;
+          break;
+        }
+      }
+      if (nu == 0)
+        error->all(FLERR, "Unknown nutrient name in fix kinetics/growth/matrix");
+      nu_index[n] = nu;
+      nu_coeff[n] = nu_entries[k].coeff;
+      n++;
+    }
+    grow_coeff[p][0] = 0;
+    grow_coeff[p][1] = 0;
+  }
+  nu_start[nprocs] = n;
+
+  for (size_t k = 0; k < growth_entries.size(); k++)
+    grow_coeff[find_process(growth_entries[k].process)][0] += growth_entries[k].coeff;
+  for (size_t k = 0; k < eps_entries.size(); k++) {
+    int p = find_process(eps_entries[k].process);
+    grow_coeff[p][1] += eps_entries[k].coeff;
+    epsflag[procs[p].type] = 1;
+  }
+
+  max_depth = 0;
+  for (int p = 0; p < nprocs; p++) {
+    compile_process(procs[p]);
+    max_depth = MAX(max_depth, procs[p].depth);
+  }
+
+  memory->destroy(stack);
+  stack = memory->create(stack, max_depth * MATRIX_BLOCK, "matrix:stack");
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixKineticsMatrix::find_process(const std::string &name) {
+  for (size_t p = 0; p < procs.size(); p++)
+    if (procs[p].name == name) return p;
+  error->all(FLERR, "Unknown process name in fix kinetics/growth/matrix");
+  return -1;
+}
+
+/* ----------------------------------------------------------------------
+ compile a rate expression into stack machine bytecode
+
+ constant subexpressions are folded at compile time and binary
+ operations with one constant operand use the C/R variants, so
+ constants never occupy an evaluation stack slot
+ ------------------------------------------------------------------------- */
+void FixKineticsMatrix::compile_process(Process &p) {
+  p.code.clear();
+  p.depth = 0;
+  cur = &p;
+  depth = 0;
+  ptr = p.expr.c_str();
+
+  Value v = parse_expr();
+  skip_space();
+  if (*ptr != '\0')
+    error->all(FLERR, "Syntax error in fix kinetics/growth/matrix rate expression");
+  materialize(v);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsMatrix::emit(int op, int arg, double c) {
+  Instr instr;
+  instr.op = op;
+  instr.arg = arg;
+  instr.c = c;
+  cur->code.push_back(instr);
+
+  if (op == LOADNU || op == LOADX || op == CONST)
+    depth++;
+  else if (op >= ADD && op <= INHIB)
+    depth--;
+  cur->depth = MAX(cur->depth, depth);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsMatrix::materialize(Value &v) {
+  if (v.is_const) {
+    emit(CONST, 0, v.c);
+    v.is_const = false;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsMatrix::skip_space() {
+  while (isspace(*ptr)) ptr++;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsMatrix::Value FixKineticsMatrix::parse_expr() {
+  Value a = parse_term();
+  while (true) {
+    skip_space();
+    if (*ptr == '+') {
+      ptr++;
+      a = emit_binary(ADD, a, parse_term());
+    } else if (*ptr == '-') {
+      ptr++;
+      a = emit_binary(SUB, a, parse_term());
+    } else {
+      return a;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsMatrix::Value FixKineticsMatrix::parse_term() {
+  Value a = parse_unary();
+  while (true) {
+    skip_space();
+    if (*ptr == '*') {
+      ptr++;
+      a = emit_binary(MUL, a, parse_unary());
+    } else if (*ptr == '/') {
+      ptr++;
+      a = emit_binary(DIV, a, parse_unary());
+    } else {
+      return a;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsMatrix::Value FixKineticsMatrix::parse_unary() {
+  skip_space();
+  if (*ptr == '-') {
+    ptr++;
+    Value a = parse_unary();
+    if (a.is_const) a.c = -a.c;
+    else emit(NEG, 0, 0);
+    return a;
+  } else if (*ptr == '+') {
+    ptr++;
+    return parse_unary();
+  }
+  return parse_factor();
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsMatrix::Value FixKineticsMatrix::parse_factor() {
+  Value a = parse_primary();
+  skip_space();
+  if (*ptr == '^') {
+    ptr++;
+    // right associative, binds tighter than unary minus on its left
+    a = emit_binary(POW, a, parse_unary());
+  }
+  return a;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsMatrix::Value FixKineticsMatrix::parse_primary() {
+  skip_space();
+  Value v;
+  v.is_const = true;
+  v.c = 0;
+
+  if (*ptr == '(') {
+    ptr++;
+    v = parse_expr();
+    skip_space();
+    if (*ptr != ')')
+      error->all(FLERR, "Syntax error in fix kinetics/growth/matrix rate expression");
+    ptr++;
+    return v;
+  }
+
+  if (isdigit(*ptr) || *ptr == '.') {
+    char *end;
+    v.c = strtod(ptr, &end);
+    if (end == ptr)
+      error->all(FLERR, "Syntax error in fix kinetics/growth/matrix rate expression");
+    ptr = end;
+    return v;
+  }
+
+  if (!isalpha(*ptr) && *ptr != '_')
+    error->all(FLERR, "Syntax error in fix kinetics/growth/matrix rate expression");
+
+  const char *start = ptr;
+  while (isalnum(*ptr) || *ptr == '_') ptr++;
+  std::string name(start, ptr - start);
+
+  skip_space();
+  if (*ptr == '(') {
+    ptr++;
+    std::vector<Value> args;
+    skip_space();
+    if (*ptr != ')') {
+      while (true) {
+        args.push_back(parse_expr());
+        skip_space();
+        if (*ptr == ',') {
+          ptr++;
+        } else {
+          break;
+        }
+      }
+    }
+    if (*ptr != ')')
+      error->all(FLERR, "Syntax error in fix kinetics/growth/matrix rate expression");
+    ptr++;
+    return emit_call(name, args);
+  }
+
+  for (size_t i = 0; i < consts.size(); i++) {
+    if (consts[i].name == name) {
+      v.c = consts[i].c;
+      return v;
+    }
+  }
+  for (int i = 1; i <= bio->nnu; i++) {
+    if (name == bio->nuname[i]) {
+      emit(LOADNU, i, 0);
+      v.is_const = false;
+      return v;
+    }
+  }
+  for (int i = 1; i <= atom->ntypes; i++) {
+    if (bio->tname[i] && name == bio->tname[i]) {
+      emit(LOADX, i, 0);
+      v.is_const = false;
+      return v;
+    }
+  }
+
+  char str[256];
+  snprintf(str, 256, "Unknown name %s in fix kinetics/growth/matrix rate expression", name.c_str());
+  error->all(FLERR, str);
+  return v;
+}
+
+/* ----------------------------------------------------------------------
+ emit a binary operation on two values, a is below b on the stack
+ ------------------------------------------------------------------------- */
+FixKineticsMatrix::Value FixKineticsMatrix::emit_binary(int op, Value a, Value b) {
+  Value r;
+  r.is_const = false;
+  r.c = 0;
+
+  if (a.is_const && b.is_const) {
+    r.is_const = true;
+    switch (op) {
+    case ADD: r.c = a.c + b.c; break;
+    case SUB: r.c = a.c - b.c; break;
+    case MUL: r.c = a.c * b.c; break;
+    case DIV: r.c = a.c / b.c; break;
+    case POW: r.c = pow(a.c, b.c); break;
+    case FMIN: r.c = MIN(a.c, b.c); break;
+    case FMAX: r.c = MAX(a.c, b.c); break;
+    case MONOD: r.c = a.c / (b.c + a.c); break;
+    case INHIB: r.c = b.c / (b.c + a.c); break;
+    }
+  } else if (b.is_const) {
+    switch (op) {
+    case ADD: emit(ADDC, 0, b.c); break;
+    case SUB: emit(ADDC, 0, -b.c); break;
+    case MUL: emit(MULC, 0, b.c); break;
+    case DIV: emit(DIVC, 0, b.c); break;
+    case POW: emit(POWC, 0, b.c); break;
+    case FMIN: emit(FMINC, 0, b.c); break;
+    case FMAX: emit(FMAXC, 0, b.c); break;
+    case MONOD: emit(MONODC, 0, b.c); break;
+    case INHIB: emit(INHIBC, 0, b.c); break;
+    }
+  } else if (a.is_const) {
+    switch (op) {
+    case ADD: emit(ADDC, 0, a.c); break;
+    case SUB: emit(RSUBC, 0, a.c); break;
+    case MUL: emit(MULC, 0, a.c); break;
+    case DIV: emit(RDIVC, 0, a.c); break;
+    case POW: emit(RPOWC, 0, a.c); break;
+    case FMIN: emit(FMINC, 0, a.c); break;
+    case FMAX: emit(FMAXC, 0, a.c); break;
+    default:
+      // no variant with a constant left operand, push it and swap
+      emit(CONST, 0, a.c);
+      emit(SWAP, 0, 0);
+      emit(op, 0, 0);
+    }
+  } else {
+    emit(op, 0, 0);
+  }
+
+  return r;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixKineticsMatrix::Value FixKineticsMatrix::emit_call(const std::string &name, std::vector<Value> &args) {
+  int nargs = args.size();
+  Value a;
+  a.is_const = true;
+  a.c = 0;
+  if (nargs > 0) a = args[0];
+
+  if (name == "exp" || name == "log" || name == "sqrt") {
+    if (nargs != 1)
+      error->all(FLERR, "Syntax error in fix kinetics/growth/matrix rate expression");
+    if (a.is_const) {
+      if (name == "exp") a.c = exp(a.c);
+      else if (name == "log") a.c = log(a.c);
+      else a.c = sqrt(a.c);
+    } else {
+      if (name == "exp") emit(EXP, 0, 0);
+      else if (name == "log") emit(LOG, 0, 0);
+      else emit(SQRT, 0, 0);
+    }
+    return a;
+  }
+
+  int op;
+  if (name == "pow") op = POW;
+  else if (name == "min") op = FMIN;
+  else if (name == "max") op = FMAX;
+  else if (name == "monod") op = MONOD;
+  else if (name == "inhib") op = INHIB;
+  else {
+    char str[256];
+    snprintf(str, 256, "Unknown function %s in fix kinetics/growth/matrix rate expression", name.c_str());
+    error->all(FLERR, str);
+    return a;
+  }
+
+  if (nargs != 2)
+    error->all(FLERR, "Syntax error in fix kinetics/growth/matrix rate expression");
+
+  return emit_binary(op, args[0], args[1]);
+}
+
+/* ----------------------------------------------------------------------
+ evaluate a compiled rate expression on grids [first, first+n)
+ returns a pointer to the result, valid until the next call
+ ------------------------------------------------------------------------- */
+double *FixKineticsMatrix::eval(const Process &p, int first, int n) {
+  double **nus = kinetics->nus;
+  double **xdensity = kinetics->xdensity;
+
+  int top = -1;
+  const int ninstr = p.code.size();
+
+  for (int k = 0; k < ninstr; k++) {
+    const Instr &instr = p.code[k];
+    const double c = instr.c;
+    double *a = &stack[MAX(top, 0) * MATRIX_BLOCK];
+    double *b = &stack[MAX(top - 1, 0) * MATRIX_BLOCK];
+
+    switch (instr.op) {
+    case LOADNU: {
+      const double *s = &nus[instr.arg][first];
+      a = &stack[(top + 1) * MATRIX_BLOCK];
+      for (int j = 0; j < n; j++) a[j] = s[j];
+      top++;
+      break;
+    }
+    case LOADX: {
+      const double *s = &xdensity[instr.arg][first];
+      a = &stack[(top + 1) * MATRIX_BLOCK];
+      for (int j = 0; j < n; j++) a[j] = s[j];
+      top++;
+      break;
+    }
+    case CONST:
+      a = &stack[(top + 1) * MATRIX_BLOCK];
+      for (int j = 0; j < n; j++) a[j] = c;
+      top++;
+      break;
+    case SWAP:
+      for (int j = 0; j < n; j++) {
+        double tmp = a[j];
+        a[j] = b[j];
+        b[j] = tmp;
+      }
+      break;
+    case NEG:    for (int j = 0; j < n; j++) a[j] = -a[j]; break;
+    case EXP:    for (int j = 0; j < n; j++) a[j] = exp(a[j]); break;
+    case LOG:    for (int j = 0; j < n; j++) a[j] = log(a[j]); break;
+    case SQRT:   for (int j = 0; j < n; j++) a[j] = sqrt(a[j]); break;
+    case ADDC:   for (int j = 0; j < n; j++) a[j] += c; break;
+    case RSUBC:  for (int j = 0; j < n; j++) a[j] = c - a[j]; break;
+    case MULC:   for (int j = 0; j < n; j++) a[j] *= c; break;
+    case DIVC:   for (int j = 0; j < n; j++) a[j] /= c; break;
+    case RDIVC:  for (int j = 0; j < n; j++) a[j] = c / a[j]; break;
+    case POWC:   for (int j = 0; j < n; j++) a[j] = pow(a[j], c); break;
+    case RPOWC:  for (int j = 0; j < n; j++) a[j] = pow(c, a[j]); break;
+    case FMINC:   for (int j = 0; j < n; j++) a[j] = MIN(a[j], c); break;
+    case FMAXC:   for (int j = 0; j < n; j++) a[j] = MAX(a[j], c); break;
+    case MONODC: for (int j = 0; j < n; j++) a[j] = a[j] / (c + a[j]); break;
+    case INHIBC: for (int j = 0; j < n; j++) a[j] = c / (c + a[j]); break;
+    case ADD:    for (int j = 0; j < n; j++) b[j] += a[j]; top--; break;
+    case SUB:    for (int j = 0; j < n; j++) b[j] -= a[j]; top--; break;
+    case MUL:    for (int j = 0; j < n; j++) b[j] *= a[j]; top--; break;
+    case DIV:    for (int j = 0; j < n; j++) b[j] /= a[j]; top--; break;
+    case POW:    for (int j = 0; j < n; j++) b[j] = pow(b[j], a[j]); top--; break;
+    case FMIN:    for (int j = 0; j < n; j++) b[j] = MIN(b[j], a[j]); top--; break;
+    case FMAX:    for (int j = 0; j < n; j++) b[j] = MAX(b[j], a[j]); top--; break;
+    case MONOD:  for (int j = 0; j < n; j++) b[j] = b[j] / (a[j] + b[j]); top--; break;
+    case INHIB:  for (int j = 0; j < n; j++) b[j] = a[j] / (a[j] + b[j]); top--; break;
+    }
+  }
+
+  return stack;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixKineticsMatrix::grow_subgrid(int n) {
+  growrate = memory->grow(growrate, atom->ntypes + 1, 2, n, "matrix:growrate");
+}
+
+/* ----------------------------------------------------------------------
+ metabolism and atom update
+
+ rates are evaluated block by block; nur[nu] accumulates
+ S[p][nu] * r[p] * xdensity[type(p)] over the sparse rows of the
+ stoichiometric matrix and growrate[type(p)] accumulates the growth
+ and EPS coefficients times r[p]
+ ------------------------------------------------------------------------- */
+void FixKineticsMatrix::growth(double dt, int gflag) {
+  int ntypes = atom->ntypes;
+  int bgrids = kinetics->bgrids;
+  int nprocs = procs.size();
+
+  double **nur = kinetics->nur;
+  double **xdensity = kinetics->xdensity;
+
+  for (int first = 0; first < bgrids; first += MATRIX_BLOCK) {
+    const int n = MIN(MATRIX_BLOCK, bgrids - first);
+
+    for (int t = 1; t <= ntypes; t++) {
+      double *gr0 = &growrate[t][0][first];
+      double *gr1 = &growrate[t][1][first];
+      for (int j = 0; j < n; j++) {
+        gr0[j] = 0;
+        gr1[j] = 0;
+      }
+    }
+
+    for (int p = 0; p < nprocs; p++) {
+      const int t = procs[p].type;
+      const double *r = eval(procs[p], first, n);
+      const double *x = &xdensity[t][first];
+
+      for (int k = nu_start[p]; k < nu_start[p+1]; k++) {
+        const double coeff = nu_coeff[k];
+        double *dst = &nur[nu_index[k]][first];
+        for (int j = 0; j < n; j++)
+          dst[j] += coeff * r[j] * x[j];
+      }
+
+      const double g0 = grow_coeff[p][0];
+      const double g1 = grow_coeff[p][1];
+      double *gr0 = &growrate[t][0][first];
+      double *gr1 = &growrate[t][1][first];
+      if (g0 != 0)
+        for (int j = 0; j < n; j++)
+          gr0[j] += g0 * r[j];
+      if (g1 != 0)
+        for (int j = 0; j < n; j++)
+          gr1[j] += g1 * r[j];
+    }
+  }
+
+  if (gflag && external_gflag) update_biomass(growrate, dt);
+}
+
+/* ----------------------------------------------------------------------
+ update particle attributes: biomass, outer mass, radius etc
+ ------------------------------------------------------------------------- */
+void FixKineticsMatrix::update_biomass(double ***growrate, double dt) {
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int *type = atom->type;
+  int *atom_cell = kinetics->atom_cell;
+
+  // growth rates of the cells of local atoms owned by other procs
+  kinetics->forward_cells(growrate[0], 2 * (atom->ntypes + 1));
+
+  biomass->reserve(nlocal);
+  int *mode = biomass->mode;
+  double *grow = biomass->grow;
+  double *eps = biomass->eps;
+
+  for (int i = 0; i < nlocal; i++) {
+    int t = type[i];
+    int pos = atom_cell[i];
+    int in = (mask[i] & groupbit) != 0;
+
+    grow[i] = in ? growrate[t][0][pos] * dt : 0.0;
+    eps[i] = in ? growrate[t][1][pos] * dt : 0.0;
+    mode[i] = !in ? BiomassUpdate::FIXED : (epsflag[t] ? BiomassUpdate::SHELL : BiomassUpdate::PLAIN);
+  }
+
+  biomass->apply(nlocal, eps_dens);
+}
@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(kinetics/growth/matrix,FixKineticsMatrix)
+
+#else
+
+#ifndef SRC_FIX_KINETICSMATRIX_H
+#define SRC_FIX_KINETICSMATRIX_H
+
+#include "fix.h"
+
+#include <string>
+#include <vector>
+
+namespace LAMMPS_NS {
+
+class FixKineticsMatrix : public Fix {
+ public:
+  FixKineticsMatrix(class LAMMPS *, int, char **);
+  ~FixKineticsMatrix();
+  void init();
+  int setmask();
+  void grow_subgrid(int);
+  void growth(double, int);
+
+  int external_gflag;
+
+ private:
+  // one bytecode instruction of a compiled rate expression
+  struct Instr {
+    int op;                         // opcode
+    int arg;                        // nutrient or type index for load instructions
+    double c;                       // constant operand
+  };
+
+  struct Process {
+    std::string name;
+    std::string tname;              // name of the type catalysing the process
+    std::string expr;               // rate expression as given in the input
+    int type;                       // type index resolved at init
+    std::vector<Instr> code;        // compiled rate expression
+    int depth;                      // evaluation stack depth required by code
+  };
+
+  struct Entry {
+    std::string process;
+    std::string target;             // nutrient name, empty for growth and eps entries
+    double coeff;
+  };
+
+  struct Const {
+    std::string name;
+    std::string value;              // number or v_name
+    double c;
+  };
+
+  std::vector<Process> procs;
+  std::vector<Const> consts;
+  std::vector<Entry> nu_entries, growth_entries, eps_entries;
+
+  // stoichiometric matrix in compressed sparse row format, one row per process
+  int *nu_start;                    // first entry of each row [nprocs+1]
+  int *nu_index;                    // nutrient index of each entry
+  double *nu_coeff;                 // stoichiometric coefficient of each entry
+  double **grow_coeff;              // coefficient of each process in growrate [process][2]
+
+  int *epsflag;                     // 1 if the type produces EPS [type]
+  double ***growrate;               // growth rate [type][2][grid]
+  double *stack;                    // evaluation stack [depth][MATRIX_BLOCK]
+  int max_depth;
+
+  char *var;                        // EPS density variable name
+  int ivar;
+  double eps_dens;                  // EPS density
+
+  class AtomVecBio *avec;
+  class BiomassUpdate *biomass;
+  class FixKinetics *kinetics;
+  class BIO *bio;
+
+  void compile();
+  void compile_process(Process &);
+  int find_process(const std::string &);
+  double *eval(const Process &, int, int);
+  void update_biomass(double ***, double);
+
+  // recursive descent parser emitting bytecode
+  struct Value {
+    bool is_const;
+    double c;
+  };
+  const char *ptr;
+  Process *cur;
+  int depth;
+  Value parse_expr();
+  Value parse_term();
+  Value parse_factor();
+  Value parse_unary();
+  Value parse_primary();
+  Value emit_binary(int, Value, Value);
+  Value emit_call(const std::string &, std::vector<Value> &);
+  void emit(int, int, double);
+  void skip_space();
+  void materialize(Value &);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal fix kinetics/growth/matrix command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Syntax error in fix kinetics/growth/matrix rate expression
+
+The rate expression could not be parsed.  Expressions may use numbers,
+constants, nutrient names, type names, the operators + - * / ^ and the
+functions exp, log, sqrt, pow, min, max, monod and inhib.
+
+*/
@@ -19,6 +19,7 @@
 
 #include "atom.h"
 #include "atom_vec_bio.h"
+#include "comm.h"
 #include "domain.h"
 #include "error.h"
 #include "force.h"
@@ -28,6 +29,7 @@
 #include "memory.h"
 
 #include "bio.h"
+#include "biomass_update.h"
 #include "fix_bio_kinetics.h"
 #include "fix_bio_kinetics_monod.h"
 #include "modify.h"
@@ -42,6 +44,10 @@ using namespace MathConst;
 
 using namespace std;
 
+enum {UNKNOWN, HET, AOB, NOB, EPS, DEAD};
+
+#define MONOD_BLOCK 256
+
 /* ---------------------------------------------------------------------- */
 
 FixKineticsMonod::FixKineticsMonod(LAMMPS *lmp, int narg, char **arg) :
@@ -50,6 +56,8 @@ FixKineticsMonod::FixKineticsMonod(LAMMPS *lmp, int narg, char **arg) :
   if (!avec)
     error->all(FLERR, "Fix kinetics requires atom style bio");
 
+  biomass = new BiomassUpdate(lmp);
+
   if (narg < 5)
     error->all(FLERR, "Not enough arguments in fix kinetics/growth/monod command");
 
@@ -81,6 +89,7 @@ FixKineticsMonod::FixKineticsMonod(LAMMPS *lmp, int narg, char **arg) :
 /* ---------------------------------------------------------------------- */
 
 FixKineticsMonod::~FixKineticsMonod() {
+  delete biomass;
   int i;
   for (i = 0; i < 2; i++) {
     delete[] var[i];
@@ -216,10 +225,10 @@ void FixKineticsMonod::init_param() {
   // initialize type
   for (int i = 1; i <= atom->ntypes; i++) {
     if (strcmp(bio->tname[i], "eps") == 0) {
-      species[i] = 4;
+      species[i] = EPS;
       ieps = i;
     } else if (strcmp(bio->tname[i], "dead") == 0) {
-      species[i] = 5;
+      species[i] = DEAD;
       idead = i;
     } else {
       // take first three char
@@ -228,11 +237,11 @@ void FixKineticsMonod::init_param() {
       name[3] = 0;
 
       if (strcmp(name, "het") == 0)
-        species[i] = 1;
+        species[i] = HET;
       else if (strcmp(name, "aob") == 0)
-        species[i] = 2;
+        species[i] = AOB;
       else if (strcmp(name, "nob") == 0)
-        species[i] = 3;
+        species[i] = NOB;
       else
         error->all(FLERR, "unknow species in fix_kinetics/kinetics/monod");
 
@@ -245,22 +254,20 @@ void FixKineticsMonod::init_param() {
 }
 
 void FixKineticsMonod::grow_subgrid(int n) {
-  growrate = memory->create(growrate, atom->ntypes + 1, 2, n, "monod:growrate");
+  growrate = memory->grow(growrate, atom->ntypes + 1, 2, n, "monod:growrate");
 }
 
 /* ----------------------------------------------------------------------
  metabolism and atom update
+
+ grids are processed in blocks of MONOD_BLOCK; for each type the monod
+ factors are evaluated once per grid into small temporary arrays and the
+ rate expressions are then applied in branch-free inner loops over the
+ block, so the species test is hoisted out of the grid loop
  ------------------------------------------------------------------------- */
 void FixKineticsMonod::growth(double dt, int gflag) {
-  int *mask = atom->mask;
-  int nlocal = atom->nlocal;
-  int *type = atom->type;
   int ntypes = atom->ntypes;
-
-  double *radius = atom->radius;
-  double *rmass = atom->rmass;
-  double *outer_mass = avec->outer_mass;
-  double *outer_radius = avec->outer_radius;
+  int bgrids = kinetics->bgrids;
 
   double *mu = bio->mu;
   double *decay = bio->decay;
@@ -273,75 +280,163 @@ void FixKineticsMonod::growth(double dt, int gflag) {
 
   double **xdensity = kinetics->xdensity;
 
-  int *nuconv = kinetics->nuconv;
   double yield_eps = 0;
 
   if (ieps != 0) yield_eps = yield[ieps];
 
-  for (int grid = 0; grid < kinetics->bgrids; grid++) {
-    //empty grid is not considered
-    if(!xdensity[0][grid]) continue;
-
+  const int nblocks = (bgrids + MONOD_BLOCK - 1) / MONOD_BLOCK;
+
+  // blocks are independent and are distributed over the threads
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
+  for (int iblock = 0; iblock < nblocks; iblock++) {
+    const int first = iblock * MONOD_BLOCK;
+    const int n = MIN(MONOD_BLOCK, bgrids - first);
+
+    // monod factors of the current type over the block
+    double msub[MONOD_BLOCK], mo2[MONOD_BLOCK], io2_inhib[MONOD_BLOCK];
+    double mnh4[MONOD_BLOCK], mno2[MONOD_BLOCK], mno3[MONOD_BLOCK];
+
+    const double *s_sub = &nus[isub][first];
+    const double *s_o2 = &nus[io2][first];
+    const double *s_nh4 = &nus[inh4][first];
+    const double *s_no2 = &nus[ino2][first];
+    const double *s_no3 = &nus[ino3][first];
+
+    double *r_sub = &nur[isub][first];
+    double *r_o2 = &nur[io2][first];
+    double *r_nh4 = &nur[inh4][first];
+    double *r_no2 = &nur[ino2][first];
+    double *r_no3 = &nur[ino3][first];
+
+    // empty grids need no special treatment: their type densities are
+    // all zero, so they add nothing to nur
     for (int i = 1; i <= ntypes; i++) {
-      int spec = species[i];
-
-      // HET monod model
-      if (spec == 1) {
-        double R1 = mu[i] * (nus[isub][grid] / (ks[i][isub] + nus[isub][grid])) * (nus[io2][grid] / (ks[i][io2] + nus[io2][grid]));
-        double R4 = eta_het * mu[i] * (nus[isub][grid] / (ks[i][isub] + nus[isub][grid])) * (nus[ino3][grid] / (ks[i][ino3] + nus[ino3][grid])) * (ks[i][io2] / (ks[i][io2] + nus[io2][grid]));
-        double R5 = eta_het * mu[i] * (nus[isub][grid] / (ks[i][isub] + nus[isub][grid])) * (nus[ino2][grid] / (ks[i][ino2] + nus[ino2][grid])) * (ks[i][io2] / (ks[i][io2] + nus[io2][grid]));
-        double R6 = decay[i];
-
-        double R10 = maintain[i] * (nus[io2][grid] / (ks[i][io2] + nus[io2][grid]));
-        double R13 = (1 / 2.86) * maintain[i] * eta_het * (nus[ino3][grid] / (ks[i][ino3] + nus[ino3][grid])) * (ks[i][io2] / (ks[i][io2] + nus[io2][grid]));
-        double R14 = (1 / 1.17) * maintain[i] * eta_het * (nus[ino2][grid] / (ks[i][ino2] + nus[ino2][grid])) * (ks[i][io2] / (ks[i][io2] + nus[io2][grid]));
-
-        nur[isub][grid] += ((-1 / yield[i]) * ((R1 + R4 + R5) * xdensity[i][grid]));
-      //if (xtype[i][grid] != 0) printf("nuR = %e \n", xtype[i][grid]);
-        nur[io2][grid] += (-((1 - yield[i] - yield_eps) / yield[i]) * R1 * xdensity[i][grid]);
-        nur[ino2][grid] += -(((1 - yield[i] - yield_eps) / (1.17 * yield[i])) * R5 * xdensity[i][grid]);
-        nur[ino3][grid] += -(((1 - yield[i] - yield_eps) / (2.86 * yield[i])) * R4 * xdensity[i][grid]);
-        nur[io2][grid] += -(R10 * xdensity[i][grid]);
-        nur[ino2][grid] += -(R14 * xdensity[i][grid]);
-        nur[ino3][grid] += -(R13 * xdensity[i][grid]);
-
-        growrate[i][0][grid] = R1 + R4 + R5 - R6 - R10 - R13 - R14;
-        growrate[i][1][grid] = (yield_eps / yield[i]) * (R1 + R4 + R5);
-      } else if (spec == 2) {
+      const double *x = &xdensity[i][first];
+      double *gr0 = &growrate[i][0][first];
+      double *gr1 = &growrate[i][1][first];
+
+      switch (species[i]) {
+      case HET: {
+        // HET monod model
+        const double ks_sub = ks[i][isub];
+        const double ks_o2 = ks[i][io2];
+        const double ks_no2 = ks[i][ino2];
+        const double ks_no3 = ks[i][ino3];
+
+        for (int j = 0; j < n; j++) {
+          msub[j] = s_sub[j] / (ks_sub + s_sub[j]);
+          mo2[j] = s_o2[j] / (ks_o2 + s_o2[j]);
+          io2_inhib[j] = ks_o2 / (ks_o2 + s_o2[j]);
+          mno2[j] = s_no2[j] / (ks_no2 + s_no2[j]);
+          mno3[j] = s_no3[j] / (ks_no3 + s_no3[j]);
+        }
+
+        const double mu_i = mu[i];
+        const double eta_mu = eta_het * mu[i];
+        const double R6 = decay[i];
+        const double maint = maintain[i];
+        const double maint_no3 = (1 / 2.86) * maintain[i] * eta_het;
+        const double maint_no2 = (1 / 1.17) * maintain[i] * eta_het;
+        const double y_sub = (-1 / yield[i]);
+        const double y_o2 = -((1 - yield[i] - yield_eps) / yield[i]);
+        const double y_no2 = ((1 - yield[i] - yield_eps) / (1.17 * yield[i]));
+        const double y_no3 = ((1 - yield[i] - yield_eps) / (2.86 * yield[i]));
+        const double y_eps = (yield_eps / yield[i]);
+
+        for (int j = 0; j < n; j++) {
+          double R1 = mu_i * msub[j] * mo2[j];
+          double R4 = eta_mu * msub[j] * mno3[j] * io2_inhib[j];
+          double R5 = eta_mu * msub[j] * mno2[j] * io2_inhib[j];
+
+          double R10 = maint * mo2[j];
+          double R13 = maint_no3 * mno3[j] * io2_inhib[j];
+          double R14 = maint_no2 * mno2[j] * io2_inhib[j];
+
+          r_sub[j] += (y_sub * ((R1 + R4 + R5) * x[j]));
+          r_o2[j] += (y_o2 * R1 * x[j]);
+          r_no2[j] += -(y_no2 * R5 * x[j]);
+          r_no3[j] += -(y_no3 * R4 * x[j]);
+          r_o2[j] += -(R10 * x[j]);
+          r_no2[j] += -(R14 * x[j]);
+          r_no3[j] += -(R13 * x[j]);
+
+          gr0[j] = R1 + R4 + R5 - R6 - R10 - R13 - R14;
+          gr1[j] = y_eps * (R1 + R4 + R5);
+        }
+        break;
+      }
+      case AOB: {
         // AOB monod model
-        double R2 = mu[i] * (nus[inh4][grid] / (ks[i][inh4] + nus[inh4][grid])) * (nus[io2][grid] / (ks[i][io2] + nus[io2][grid]));
-        double R7 = decay[i];
-        double R11 = maintain[i] * (nus[io2][grid] / (ks[i][io2] + nus[io2][grid]));
-        nur[io2][grid] += -(((3.42 - yield[i]) / yield[i]) * R2 * xdensity[i][grid]);
-        // For BM3
-        //nur[io2][grid] += -(((4.57 - yield[i]) / yield[i]) * R2 * xdensity[i][grid]);
-        nur[inh4][grid] += -(1 / yield[i]) * R2 * xdensity[i][grid];
-        nur[ino2][grid] += (1 / yield[i]) * R2 * xdensity[i][grid];
-        nur[io2][grid] += -(R11 * xdensity[i][grid]);
-
-        growrate[i][0][grid] = R2 - R7 - R11;
-      } else if (spec == 3) {
+        const double ks_o2 = ks[i][io2];
+        const double ks_nh4 = ks[i][inh4];
+
+        for (int j = 0; j < n; j++) {
+          mnh4[j] = s_nh4[j] / (ks_nh4 + s_nh4[j]);
+          mo2[j] = s_o2[j] / (ks_o2 + s_o2[j]);
+        }
+
+        const double mu_i = mu[i];
+        const double R7 = decay[i];
+        const double maint = maintain[i];
+        // for BM3 use (4.57 - yield[i]) as the oxygen coefficient
+        const double y_o2 = ((3.42 - yield[i]) / yield[i]);
+        const double y_n = (1 / yield[i]);
+
+        for (int j = 0; j < n; j++) {
+          double R2 = mu_i * mnh4[j] * mo2[j];
+          double R11 = maint * mo2[j];
+
+          r_o2[j] += -(y_o2 * R2 * x[j]);
+          r_nh4[j] += -y_n * R2 * x[j];
+          r_no2[j] += y_n * R2 * x[j];
+          r_o2[j] += -(R11 * x[j]);
+
+          gr0[j] = R2 - R7 - R11;
+        }
+        break;
+      }
+      case NOB: {
         // NOB monod model
-        double R3 = mu[i] * (nus[ino2][grid] / (ks[i][ino2] + nus[ino2][grid])) * (nus[io2][grid] / (ks[i][io2] + nus[io2][grid]));
-        double R8 = decay[i];
-        double R12 = maintain[i] * (nus[io2][grid] / (ks[i][io2] + nus[io2][grid]));
-
-        nur[io2][grid] += -(((1.15 - yield[i]) / yield[i]) * R3 * xdensity[i][grid]);
-        nur[ino2][grid] += -(1 / yield[i]) * R3 * xdensity[i][grid];
-        nur[ino3][grid] += (1 / yield[i]) * R3 * xdensity[i][grid];
-        nur[io2][grid] += -(R12 * xdensity[i][grid]);
-
-        growrate[i][0][grid] = R3 - R8 - R12;
-      } else if (spec == 4) {
-        // EPS monod model
-        double R9 = decay[i];
-
-        nur[isub][grid] += R9 * xdensity[i][grid];
-        growrate[i][0][grid] = -decay[i];
-      } else if (spec == 5) {
-        // DEAD monod model
-        nur[isub][grid] += (decay[i] * xdensity[i][grid]);
-        growrate[i][0][grid] = -decay[i];
+        const double ks_o2 = ks[i][io2];
+        const double ks_no2 = ks[i][ino2];
+
+        for (int j = 0; j < n; j++) {
+          mno2[j] = s_no2[j] / (ks_no2 + s_no2[j]);
+          mo2[j] = s_o2[j] / (ks_o2 + s_o2[j]);
+        }
+
+        const double mu_i = mu[i];
+        const double R8 = decay[i];
+        const double maint = maintain[i];
+        const double y_o2 = ((1.15 - yield[i]) / yield[i]);
+        const double y_n = (1 / yield[i]);
+
+        for (int j = 0; j < n; j++) {
+          double R3 = mu_i * mno2[j] * mo2[j];
+          double R12 = maint * mo2[j];
+
+          r_o2[j] += -(y_o2 * R3 * x[j]);
+          r_no2[j] += -y_n * R3 * x[j];
+          r_no3[j] += y_n * R3 * x[j];
+          r_o2[j] += -(R12 * x[j]);
+
+          gr0[j] = R3 - R8 - R12;
+        }
+        break;
+      }
+      case EPS:
+      case DEAD: {
+        // EPS and DEAD monod model
+        const double R9 = decay[i];
+
+        for (int j = 0; j < n; j++) {
+          r_sub[j] += (R9 * x[j]);
+          gr0[j] = -R9;
+        }
+        break;
+      }
       }
     }
   }
@@ -356,33 +451,25 @@ void FixKineticsMonod::update_biomass(double ***growrate, double dt) {
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
   int *type = atom->type;
+  int *atom_cell = kinetics->atom_cell;
 
-  double *radius = atom->radius;
-  double *rmass = atom->rmass;
-  double *outer_mass = avec->outer_mass;
-  double *outer_radius = avec->outer_radius;
+  // growth rates of the cells of local atoms owned by other procs
+  kinetics->forward_cells(growrate[0], 2 * (atom->ntypes + 1));
 
-  const double three_quarters_pi = (3.0 / (4.0 * MY_PI));
-  const double four_thirds_pi = 4.0 * MY_PI / 3.0;
-  const double third = 1.0 / 3.0;
+  biomass->reserve(nlocal);
+  int *mode = biomass->mode;
+  double *grow = biomass->grow;
+  double *eps = biomass->eps;
 
   for (int i = 0; i < nlocal; i++) {
-    if (mask[i] & groupbit) {
-      int t = type[i];
-      int pos = kinetics->position(i);
-
-      double density = rmass[i] / (four_thirds_pi * radius[i] * radius[i] * radius[i]);
-      rmass[i] = rmass[i] * (1 + growrate[t][0][pos] * dt);
-
-      if (species[t] == 1) {
-        outer_mass[i] = four_thirds_pi * (outer_radius[i] * outer_radius[i] * outer_radius[i] - radius[i] * radius[i] * radius[i]) * eps_dens + growrate[t][1][pos] * rmass[i] * dt;
-        outer_radius[i] = pow(three_quarters_pi * (rmass[i] / density + outer_mass[i] / eps_dens), third);
-        radius[i] = pow(three_quarters_pi * (rmass[i] / density), third);
-      } else {
-        radius[i] = pow(three_quarters_pi * (rmass[i] / density), third);
-        outer_mass[i] = rmass[i];
-        outer_radius[i] = radius[i];
-      }
-    }
+    int t = type[i];
+    int pos = atom_cell[i];
+    int in = (mask[i] & groupbit) != 0;
+
+    grow[i] = in ? growrate[t][0][pos] * dt : 0.0;
+    eps[i] = in ? growrate[t][1][pos] * dt : 0.0;
+    mode[i] = !in ? BiomassUpdate::FIXED : (species[t] == HET ? BiomassUpdate::SHELL : BiomassUpdate::PLAIN);
   }
+
+  biomass->apply(nlocal, eps_dens);
 }
@@ -51,6 +51,7 @@ class FixKineticsMonod : public Fix {
   double eta_het;                   // HET reduction factor in anoxic condition
 
   class AtomVecBio *avec;
+  class BiomassUpdate *biomass;
   class FixKinetics *kinetics;
   class BIO *bio;
 
@@ -30,6 +30,7 @@
 
 #include "bio.h"
 #include "fix_bio_kinetics.h"
+#include "kinetics_dispatch.h"
 #include "modify.h"
 #include "pointers.h"
 #include "variable.h"
@@ -48,6 +49,7 @@ FixKineticsPH::FixKineticsPH(LAMMPS *lmp, int narg, char **arg) :
     error->all(FLERR, "Not enough arguments in fix kinetics/ph command");
 
   //set default values
+  newton_iters = 0;
   buffer_flag = 0;
   phflag = 0;
   iph = 7.0;
@@ -112,6 +114,23 @@ void FixKineticsPH::init() {
 
   keq = memory->create(keq, nnus + 1, 4, "kinetics/ph:keq");
 
+  ih = MAX(bio->find_nuid("h"), 0);
+
+#define PH_CASE(N) \
+  case N: \
+    compute_activity_fn = &FixKineticsPH::compute_activity_n<N>; \
+    dynamic_ph_fn = &FixKineticsPH::dynamic_ph_n<N>; \
+    break;
+
+  switch (nnus) {
+  NUFEB_NNU_CASES(PH_CASE)
+  default:
+    compute_activity_fn = &FixKineticsPH::compute_activity_n<0>;
+    dynamic_ph_fn = &FixKineticsPH::dynamic_ph_n<0>;
+  }
+
+#undef PH_CASE
+
   init_keq();
   compute_activity(0, kinetics->ngrids, iph);
 }
@@ -158,55 +177,69 @@ void FixKineticsPH::init_keq() {
  ------------------------------------------------------------------------- */
 
 void FixKineticsPH::compute_activity(int first, int last, double iph) {
-  int nnus = bio->nnu;
+  (this->*compute_activity_fn)(first, last, iph);
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int NNU>
+void FixKineticsPH::compute_activity_n(int first, int last, double iph) {
+  const int nnus = NNU > 0 ? NNU : bio->nnu;
   double *sh = kinetics->sh;
   double **nus = kinetics->nus;
   double ***activity = kinetics->activity;
 
-  double *denm = memory->create(denm, nnus + 1, "kinetics:denm");
   double gSh = pow(10, -iph);
   double gSh2 = gSh * gSh;
   double gSh3 = gSh * gSh2;
 
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
+  for (int j = first; j < last; j++)
+    sh[j] = gSh;
+
   for (int k = 1; k < nnus + 1; k++) {
-    denm[k] = (1 + keq[k][0]) * gSh3 + keq[k][1] * gSh2 + keq[k][2] * keq[k][3] * gSh
+    double denm = (1 + keq[k][0]) * gSh3 + keq[k][1] * gSh2 + keq[k][2] * keq[k][3] * gSh
         + keq[k][3] * keq[k][2] * keq[k][1];
-    if (denm[k] == 0) {
+    if (denm == 0) {
       lmp->error->all(FLERR, "denm returns a zero value");
     }
     double tmp[5];
-    tmp[0] = keq[k][0] * gSh3 / denm[k];
-    tmp[1] = gSh3 / denm[k];
-    tmp[2] = gSh2 * keq[k][1] / denm[k];
-    tmp[3] = gSh * keq[k][1] * keq[k][2] / denm[k];
-    tmp[4] = keq[k][1] * keq[k][2] * keq[k][3] / denm[k];
-    bool is_hydrogen = false;
-    if (strcmp(bio->nuname[k], "h") == 0) {
-      is_hydrogen = true;
-    }
-
-#pragma ivdep
-#pragma vector aligned
+    tmp[0] = keq[k][0] * gSh3 / denm;
+    tmp[1] = gSh3 / denm;
+    tmp[2] = gSh2 * keq[k][1] / denm;
+    tmp[3] = gSh * keq[k][1] * keq[k][2] / denm;
+    tmp[4] = keq[k][1] * keq[k][2] * keq[k][3] / denm;
+
+    const double *s = nus[k];
+    double *a0 = activity[k][0];
+    double *a1 = activity[k][1];
+    double *a2 = activity[k][2];
+    double *a3 = activity[k][3];
+    double *a4 = activity[k][4];
+
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
     for (int j = first; j < last; j++) {
-      sh[j] = gSh;
       // not hydrated form acitivity
-      activity[k][0][j] = nus[k][j] * tmp[0];
+      a0[j] = s[j] * tmp[0];
       // fully protonated form activity
-      if (is_hydrogen) {
-        activity[k][1][j] = gSh;
-      } else {
-        activity[k][1][j] = nus[k][j] * tmp[1];
-      }
+      a1[j] = s[j] * tmp[1];
       // 1st deprotonated form activity
-      activity[k][2][j] = nus[k][j] * tmp[2];
+      a2[j] = s[j] * tmp[2];
       // 2nd deprotonated form activity
-      activity[k][3][j] = nus[k][j] * tmp[3];
+      a3[j] = s[j] * tmp[3];
       // 3rd deprotonated form activity
-      activity[k][4][j] = nus[k][j] * tmp[4];
-      // if(k==1)printf("act = %e, s= %e, flag = %i \n", activity[k][1][j], nus[k][j], bio->ngflag[k]);
+      a4[j] = s[j] * tmp[4];
+    }
+
+    if (k == ih) {
+      for (int j = first; j < last; j++)
+        a1[j] = gSh;
     }
   }
-  memory->destroy(denm);
 }
 
 /* ----------------------------------------------------------------------
@@ -299,83 +332,89 @@ inline void set_gsh(double *gsh, double value) {
 /* ---------------------------------------------------------------------- */
 
 void FixKineticsPH::dynamic_ph(int first, int last) {
-  int w = 1;
+  (this->*dynamic_ph_fn)(first, last);
+}
 
-  double tol = 5e-15;
-  int max_iter = 100;
+/* ----------------------------------------------------------------------
+ solve the charge balance for sh with Newton-Raphson, one grid at a time
+ so that the nutrient loops are innermost
+ ------------------------------------------------------------------------- */
 
-  int nnus = bio->nnu;
+template <int NNU>
+void FixKineticsPH::dynamic_ph_n(int first, int last) {
+  const int w = 1;
 
-  double *fa = memory->create(fa, kinetics->ngrids, "kinetics/ph:fa");
-  double *fb = memory->create(fb, kinetics->ngrids, "kinetics/ph:fb");
-  double *f = memory->create(f, kinetics->ngrids, "kinetics/ph:f");
-  double *df = memory->create(df, kinetics->ngrids, "kinetics/ph:df");
+  const double tol = 5e-15;
+  const int max_iter = 100;
+
+  const int nnus = NNU > 0 ? NNU : bio->nnu;
 
   double **nus = kinetics->nus;
-  double temp = kinetics->temp;
-  double rth = kinetics->rth;
   double ***activity = kinetics->activity;
   int **nucharge = bio->nucharge;
   double *sh = kinetics->sh;
 
-  double a = 1e-14;
-  double b = 1;
+  const double a = 1e-14;
+  const double b = 1;
 
-  for (int i = first; i < last; i++) {
-    fa[i] = a;
-    fb[i] = b;
-  }
+  double gsha[3], gshb[3];
+  set_gsh(gsha, a);
+  set_gsh(gshb, b);
 
-  double gsh[3];
-  set_gsh(gsh, a);
   for (int k = 1; k < nnus + 1; k++) {
-    double denm = (1 + keq[k][0] / w) * gsh[2] + keq[k][1] * gsh[1] + keq[k][2] * keq[k][1] * gsh[0]
+    double denma = (1 + keq[k][0] / w) * gsha[2] + keq[k][1] * gsha[1] + keq[k][2] * keq[k][1] * gsha[0]
       + keq[k][3] * keq[k][2] * keq[k][1];
-    if (denm <= 0) {
-      lmp->error->all(FLERR, "denm returns a zero value");
-    }
-#pragma ivdep
-    for (int i = first; i < last; i++) {
-      fa[i] += sum_activity(activity, keq, nus, nucharge, denm, gsh, w, k, i);
-    }
-  }
-
-  set_gsh(gsh, b);
-  for (int k = 1; k < nnus + 1; k++) {
-    double denm = (1 + keq[k][0] / w) * gsh[2] + keq[k][1] * gsh[1] + keq[k][2] * keq[k][1] * gsh[0]
+    double denmb = (1 + keq[k][0] / w) * gshb[2] + keq[k][1] * gshb[1] + keq[k][2] * keq[k][1] * gshb[0]
       + keq[k][3] * keq[k][2] * keq[k][1];
-    if (denm <= 0) {
+    if (denma <= 0 || denmb <= 0) {
       lmp->error->all(FLERR, "denm returns a zero value");
     }
-#pragma ivdep
-    for (int i = first; i < last; i++) {
-      fb[i] += sum_activity(activity, keq, nus, nucharge, denm, gsh, w, k, i);
-    }
   }
 
-  bool wrong = false;
+  // the charge balance must change sign between the bounds
+  int wrong = 0;
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) reduction(|:wrong) schedule(static)
+#endif
   for (int i = first; i < last; i++) {
-    if (fa[i] * fb[i] > 0)
-      wrong = true;
+    double fa = a;
+    double fb = b;
+    for (int k = 1; k < nnus + 1; k++) {
+      double denm = (1 + keq[k][0] / w) * gsha[2] + keq[k][1] * gsha[1] + keq[k][2] * keq[k][1] * gsha[0]
+        + keq[k][3] * keq[k][2] * keq[k][1];
+      fa += sum_activity(activity, keq, nus, nucharge, denm, gsha, w, k, i);
+    }
+    for (int k = 1; k < nnus + 1; k++) {
+      double denm = (1 + keq[k][0] / w) * gshb[2] + keq[k][1] * gshb[1] + keq[k][2] * keq[k][1] * gshb[0]
+        + keq[k][3] * keq[k][2] * keq[k][1];
+      fb += sum_activity(activity, keq, nus, nucharge, denm, gshb, w, k, i);
+    }
+    if (fa * fb > 0)
+      wrong = 1;
   }
   if (wrong)
     lmp->error->all(FLERR, "The sum of charges returns a wrong value");
 
-  // Newton-Raphson method
-  int ipH = 1;
-  while (ipH <= max_iter) {
-    for (int i = first; i < last; i++) {
-      f[i] = sh[i];
-      df[i] = 1;
-    }
+  // Newton-Raphson method, the number of iterations varies between grids
+  bigint niters = 0;
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(dynamic, 64) reduction(+:niters)
+#endif
+  for (int i = first; i < last; i++) {
+    double shi = sh[i];
+    int ipH;
 
-    for (int k = 1; k < nnus + 1; k++) {
-#pragma ivdep
-      for (int i = first; i < last; i++) {
-        set_gsh(gsh, sh[i]);
+    for (ipH = 1; ipH <= max_iter; ipH++) {
+      double gsh[3];
+      set_gsh(gsh, shi);
+
+      double f = shi;
+      double df = 1;
+
+      for (int k = 1; k < nnus + 1; k++) {
         double denm = (1 + keq[k][0] / w) * gsh[2] + keq[k][1] * gsh[1] + keq[k][2] * keq[k][1] * gsh[0]
           + keq[k][3] * keq[k][2] * keq[k][1];
-        f[i] += sum_activity(activity, keq, nus, nucharge, denm, gsh, w, k, i);
+        f += sum_activity(activity, keq, nus, nucharge, denm, gsh, w, k, i);
 
         double ddenm = denm * denm;
         double aux = 3 * gsh[1] * (keq[k][0] / w + 1) + 2 * gsh[0] * keq[k][1] + keq[k][1] * keq[k][2];
@@ -385,48 +424,30 @@ void FixKineticsPH::dynamic_ph(int first, int last) {
         tmp[2] = nucharge[k][2] * ((2 * gsh[0] * keq[k][1] * nus[k][i]) / denm - (keq[k][1] * nus[k][i] * gsh[1] * aux) / ddenm);
         tmp[3] = nucharge[k][3] * ((keq[k][1] * keq[k][2] * nus[k][i]) / denm - (keq[k][1] * keq[k][2] * nus[k][i] * gsh[0] * aux) / ddenm);
         tmp[4] = nucharge[k][4] * (-(keq[k][1] * keq[k][2] * keq[k][3] * nus[k][i] * aux) / ddenm);
-        df[i] += tmp[0] + tmp[1] + tmp[2] + tmp[3] + tmp[4];
+        df += tmp[0] + tmp[1] + tmp[2] + tmp[3] + tmp[4];
       }
-    }
 
-    // Check for convergence
-    bool flag = true;
-    for (int i = first; i < last; i++) {
-      if (fabs(f[i]) >= tol)
-      {
-        flag = false;
-      }
+      // check for convergence
+      if (fabs(f) < tol) break;
+
+      // compute next value
+      double d = f / df;
+      // Prevent sh below 1e-14. That can happen because sometimes the Newton
+      // method overshoots to a negative sh value, due to a small derivative
+      // value.
+      if (d >= shi - 1e-14)
+        d = shi / 2;
+      shi -= d;
     }
-    if (flag) break;
 
-    // Compute next value
-#pragma ivdep
-    for (int i = first; i < last; i++) {
-      if (fabs(f[i]) >= tol) {
-        double d = f[i] / df[i];
-        // Prevent sh below 1e-14. That can happen because sometimes the Newton
-        // method overshoots to a negative sh value, due to a small derivative
-        // value.
-        if (d >= sh[i] - 1e-14)
-          d = sh[i] / 2;
-        sh[i] -= d;
-      }
-    }
-
-    ipH++;
+    sh[i] = shi;
+    niters += MIN(ipH, max_iter);
   }
+  newton_iters += niters;
 
-  int id = bio->find_nuid("h");
-
-  if (id > 0) {
+  if (ih > 0) {
     for (int i = first; i < last; i++) {
-      activity[id][1][i] = sh[i];
+      activity[ih][1][i] = sh[i];
     }
   }
-
-  memory->destroy(fa);
-  memory->destroy(fb);
-  memory->destroy(f);
-  memory->destroy(df);
 }
-
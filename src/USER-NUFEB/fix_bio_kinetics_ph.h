@@ -31,6 +31,7 @@ class FixKineticsPH : public Fix {
   void buffer_ph();
 
   double buffer_flag;              // 1 = buffer ph, 0 = unbuffer ph
+  bigint newton_iters;             // # of Newton iterations summed over grids, reset by fix kinetics
 
  private:
   class FixKinetics *kinetics;
@@ -40,11 +41,19 @@ class FixKineticsPH : public Fix {
   double **keq;                    // equilibrium constants [nutrient][4]
   double iph;                      // initial ph
   double phlo, phhi;               // lower and upper bounds of ph buffer
+  int ih;                          // index of nutrient h, 0 if not defined
+
+  // kernels specialised on the number of nutrients, selected in init()
+  void (FixKineticsPH::*compute_activity_fn)(int, int, double);
+  void (FixKineticsPH::*dynamic_ph_fn)(int, int);
 
   void output_data();
   void compute_activity(int, int, double);
   void init_keq();
   void dynamic_ph(int, int);
+
+  template <int NNU> void compute_activity_n(int, int, double);
+  template <int NNU> void dynamic_ph_n(int, int);
 };
 
 }
@@ -18,6 +18,7 @@
 #include <sstream>
 
 #include "atom.h"
+#include "comm.h"
 #include "domain.h"
 #include "error.h"
 #include "force.h"
@@ -27,6 +28,7 @@
 
 #include "bio.h"
 #include "fix_bio_kinetics.h"
+#include "kinetics_dispatch.h"
 #include "modify.h"
 #include "pointers.h"
 #include "variable.h"
@@ -134,6 +136,16 @@ void FixKineticsThermo::init() {
   init_khv();
   init_dgzero();
 
+#define THERMO_CASE(N) case N: gibbs_fn = &FixKineticsThermo::gibbs_n<N>; break;
+
+  switch (nnus) {
+  NUFEB_NNU_CASES(THERMO_CASE)
+  default:
+    gibbs_fn = &FixKineticsThermo::gibbs_n<0>;
+  }
+
+#undef THERMO_CASE
+
   //Get computational domain size
   if (domain->triclinic == 0) {
     xlo = domain->boxlo[0];
@@ -227,17 +239,72 @@ int FixKineticsThermo::setmask() {
  thermodynamics
  ------------------------------------------------------------------------- */
 void FixKineticsThermo::thermo(double dt) {
-  int nnus = bio->nnu;
+  (this->*gibbs_fn)();
+
+  if (yflag) dynamic_yield();
+  if (rflag) gas_liq_transfer(dt);
+}
+
+/* ----------------------------------------------------------------------
+ calculate metabolic energy
+
+ the specialised kernels (NNU > 0) work one grid at a time, keeping the
+ nutrient activity terms in a small local array; the generic kernel
+ sweeps the grids once per nutrient. Both accumulate the nutrient terms
+ in the same order.
+ ------------------------------------------------------------------------- */
+
+template <int NNU>
+void FixKineticsThermo::gibbs_n() {
+  const int nnus = NNU > 0 ? NNU : bio->nnu;
+  const int ntypes = atom->ntypes;
+  const int bgrids = kinetics->bgrids;
 
   double **gibbs_cata = kinetics->gibbs_cata;
   double **gibbs_anab = kinetics->gibbs_anab;
   double ***activity = kinetics->activity;
+  double **cata_coeff = bio->cata_coeff;
+  double **anab_coeff = bio->anab_coeff;
+  int *ngflag = bio->ngflag;
 
-  // calculate metabolic energy
   double rthT = kinetics->temp * kinetics->rth;
-  for (int i = 1; i <= atom->ntypes; i++) {
-#pragma ivdep
-    for (int grid = 0; grid < kinetics->bgrids; grid++) {
+
+  for (int nu = 1; nu <= nnus; nu++) {
+    if (bio->nugibbs_coeff[nu][1] >= 1e4)
+      error->all(FLERR, "nuGCoeff[1] is inf value");
+  }
+
+  if (NNU > 0) {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
+    for (int grid = 0; grid < bgrids; grid++) {
+      double act[NNU + 1];
+      for (int nu = 1; nu <= nnus; nu++) {
+        double a = activity[nu][ngflag[nu]][grid];
+        if (a == 0) a = 1e-20;
+        act[nu] = rthT * log(a);
+      }
+      for (int i = 1; i <= ntypes; i++) {
+        //Gibbs free energy of the reaction
+        double cata = dgzero[i][0];
+        double anab = dgzero[i][1] + rthT;
+        for (int nu = 1; nu <= nnus; nu++) {
+          cata += cata_coeff[i][nu] * act[nu];
+          anab += anab_coeff[i][nu] * act[nu];
+        }
+        gibbs_cata[i][grid] = cata;
+        gibbs_anab[i][grid] = anab;
+      }
+    }
+    return;
+  }
+
+  for (int i = 1; i <= ntypes; i++) {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
+    for (int grid = 0; grid < bgrids; grid++) {
       //Gibbs free energy of the reaction
       gibbs_cata[i][grid] = dgzero[i][0];  //catabolic energy values
       gibbs_anab[i][grid] = dgzero[i][1] + rthT;  //anabolic energy values
@@ -246,30 +313,28 @@ void FixKineticsThermo::thermo(double dt) {
 
   double *act = memory->create(act, kinetics->ngrids, "thermo:act");
   for (int nu = 1; nu <= nnus; nu++) {
-    if (bio->nugibbs_coeff[nu][1] >= 1e4)
-      error->all(FLERR, "nuGCoeff[1] is inf value");
-    int flag = bio->ngflag[nu];
-#pragma vector aligned
-    for (int grid = 0; grid < kinetics->bgrids; grid++) {
+    int flag = ngflag[nu];
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
+    for (int grid = 0; grid < bgrids; grid++) {
       if (activity[nu][flag][grid] == 0)
         act[grid] = 1e-20;
       else
         act[grid] = activity[nu][flag][grid];
       act[grid] = rthT * log(act[grid]);
     }
-    for (int i = 1; i <= atom->ntypes; i++) {
-#pragma ivdep
-#pragma vector aligned
-      for (int grid = 0; grid < kinetics->bgrids; grid++) {
-        gibbs_cata[i][grid] += bio->cata_coeff[i][nu] * act[grid];
-        gibbs_anab[i][grid] += bio->anab_coeff[i][nu] * act[grid];
+    for (int i = 1; i <= ntypes; i++) {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
+      for (int grid = 0; grid < bgrids; grid++) {
+        gibbs_cata[i][grid] += cata_coeff[i][nu] * act[grid];
+        gibbs_anab[i][grid] += anab_coeff[i][nu] * act[grid];
       }
     }
   }
   memory->destroy(act);
-
-  if (yflag) dynamic_yield();
-  if (rflag) gas_liq_transfer(dt);
 }
 
 /* ----------------------------------------------------------------------
@@ -281,10 +346,12 @@ void FixKineticsThermo::gas_liq_transfer(double dt) {
   double **nur = kinetics->nur;
   double **nus = kinetics->nus;
   double ***activity = kinetics->activity;
-  double rGas, rLiq;
   double vRgT = gvol * 1000 / (rg * kinetics->temp);
 
-
+  // each grid only updates its own nus and nur entries
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
   for (int grid = 0; grid < kinetics->bgrids; grid++) {
     for (int nu = 1; nu <= nnus; nu++) {
       if (bio->nustate[nu] != 1)
@@ -302,8 +369,8 @@ void FixKineticsThermo::gas_liq_transfer(double dt) {
         gasT = bio->kla[liqID] * (activity[nu][1][grid] - activity[liqID][0][grid] / khv[liqID]);
       }
 
-      rGas = -gasT;
-      rLiq = gasT * vRgT;
+      double rGas = -gasT;
+      double rLiq = gasT * vRgT;
       // update nutrient consumption
       nur[nu][grid] += rGas;
       nur[liqID][grid] += rLiq;
@@ -330,8 +397,9 @@ void FixKineticsThermo::dynamic_yield() {
     double ed = 0;
     if (bio->edoner[i] > 0)
       ed = -bio->anab_coeff[i][bio->edoner[i]];
-#pragma ivdep
-#pragma vector aligned
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(comm->nthreads) schedule(static)
+#endif
     for (int grid = 0; grid < kinetics->bgrids; grid++) {
       //use catabolic and anabolic energy values to derive catabolic reaction equation
       if (gibbs_cata[i][grid] < 0) {
@@ -51,6 +51,12 @@ class FixKineticsThermo : public Fix {
   void dynamic_yield();
   void gas_liq_transfer(double);
   void compute_energy();
+
+ private:
+  // gibbs kernel specialised on the number of nutrients, selected in init()
+  void (FixKineticsThermo::*gibbs_fn)();
+
+  template <int NNU> void gibbs_n();
 };
 
 }
@@ -16,6 +16,7 @@
 
 #include "atom.h"
 #include "atom_vec_bio.h"
+#include "domain.h"
 #include "bio.h"
 #include "error.h"
 #include "fix_bio_kinetics.h"
@@ -61,6 +62,12 @@ FixVerify::FixVerify(LAMMPS *lmp, int narg, char **arg) :
         error->all(FLERR, "Illegal fix divide command: demflag");
     }
   }
+
+  vector_flag = 1;
+  size_vector = NVERIFY;
+  global_freq = nevery;
+  extvector = 0;
+  for (int i = 0; i < NVERIFY; i++) observables[i] = 0.0;
 }
 
 FixVerify::~FixVerify()
@@ -102,6 +109,10 @@ void FixVerify::init()
   if (kinetics == NULL)
     lmp->error->all(FLERR, "The fix kinetics command is required");
 
+  // the cells above a free particle are not forwarded to its proc
+  if (bm2flag && kinetics->get_partition() != NULL)
+    lmp->error->all(FLERR, "Fix verify bm2 cannot be used with fix kinetics decomp grid");
+
   bio = kinetics->bio;
   vol = kinetics->stepx * kinetics->stepy * kinetics->stepz;
  // kinetics->diffusion->bulkflag = 0;
@@ -137,6 +148,7 @@ void FixVerify::end_of_step() {
   nuS = kinetics->nus;
   nnus = bio->nnu;
 
+  substrate_flux();
   if (mflag == 1) nitrogen_mass_balance();
   if (bm1flag == 1) benchmark_one();
   if (bm2flag == 1) benchmark_two();
@@ -162,11 +174,10 @@ void FixVerify::nitrogen_mass_balance() {
 
   // get biomass concentration (mol/L)
   for (int i = 0; i < nlocal; i++) {
-    int pos = kinetics->position(i);
     double rmassCellVol = atom->rmass[i] / vol;
     rmassCellVol /= 24.6;
 
-    if (pos != -1) smass += rmassCellVol;
+    smass += rmassCellVol;
   }
 
   // get overall biamass concentration
@@ -200,6 +211,7 @@ void FixVerify::nitrogen_mass_balance() {
 
   if (comm->me == 0) printf("(N) Diff = %e, Biomass = %e, NO2 = %e, NH3  = %e \n",
       left-right, diff_mass, diff_no2, diff_nh3);
+  observables[N_BALANCE] = left - right;
 
   global_pre_nh3 = global_nh3;
   global_pre_no2 = global_no2;
@@ -224,14 +236,17 @@ void FixVerify::benchmark_one() {
     if (atom->x[i][2] > maxz) maxz = atom->x[i][2];
   }
   MPI_Allreduce(&tmass,&global_tmass,1,MPI_DOUBLE,MPI_SUM,world);
-  MPI_Allreduce(&maxz,&global_maxz,1,MPI_DOUBLE,MPI_SUM,world);
+  MPI_Allreduce(&maxz,&global_maxz,1,MPI_DOUBLE,MPI_MAX,world);
 
   if (global_tmass > 1.92e-10) {
     kinetics->monod->external_gflag = 0;
   }
 
-  if (comm->me == 0 && logfile) fprintf(logfile, "maxz = %e \n",maxz);
-  if (comm->me == 0 && screen) fprintf(screen, "maxz = %e \n",maxz);
+  observables[MAXZ] = global_maxz;
+  observables[MASS] = global_tmass;
+
+  if (comm->me == 0 && logfile) fprintf(logfile, "maxz = %e \n",global_maxz);
+  if (comm->me == 0 && screen) fprintf(screen, "maxz = %e \n",global_maxz);
 
   bm1_output();
 }
@@ -248,8 +263,9 @@ void FixVerify::benchmark_two() {
   ssurf_3 = 0;
 
 
+  kinetics->update_bins();
   for(auto const& value: fslist) {
-    int grid = kinetics->position(value);
+    int grid = kinetics->atom_cell[value];
     int up = grid + kinetics->nx * kinetics->ny;  // z direction
     int up2 = grid + (kinetics->nx * kinetics->ny)*2;  // z direction
     int up3 = grid + (kinetics->nx * kinetics->ny)*3;  // z direction
@@ -264,6 +280,7 @@ void FixVerify::benchmark_two() {
   MPI_Allreduce(&ssurf,&gssurf,1,MPI_DOUBLE,MPI_SUM,world);
 
   gssurf /= comm->nprocs;
+  observables[SSURF] = gssurf;
   if (comm->me == 0 && logfile) fprintf(logfile, "ssurf = %e \n",gssurf);
   if (comm->me == 0 && screen) fprintf(screen, "ssurf = %e \n",gssurf);
 
@@ -295,6 +312,9 @@ void FixVerify::benchmark_three() {
     kinetics->monod->external_gflag = 0;
   }
 
+  observables[MAXZ] = global_maxz;
+  observables[MASS] = global_tmass;
+
   if (comm->me == 0 && logfile) fprintf(logfile, "maxz = %e \n",global_maxz);
   if (comm->me == 0 && screen) fprintf(screen, "maxz = %e \n",global_maxz);
   bm3_output();
@@ -430,6 +450,8 @@ void FixVerify::bm1_output() {
       if (comm->me == 0 && screen) fprintf(screen, "S-sub-bulk = %e\n", kinetics->nubs[nu]);
       if (comm->me == 0 && logfile) fprintf(logfile, "S-sub-bulk = %e\n", kinetics->nubs[nu]);
       double s = get_ave_s_sub_base();
+      observables[SUB_BULK] = kinetics->nubs[nu];
+      observables[SUB_BASE] = s;
       if (comm->me == 0 && screen) fprintf(screen, "S-sub-base = %e\n", s);
       if (comm->me == 0 && logfile) fprintf(logfile, "S-sub-base = %e\n", s);
     }
@@ -438,6 +460,8 @@ void FixVerify::bm1_output() {
       if (comm->me == 0 && screen) fprintf(screen, "S-o2-bulk = %e\n", kinetics->nubs[nu]);
       if (comm->me == 0 && logfile) fprintf(logfile, "S-o2-bulk = %e\n", kinetics->nubs[nu]);
       double s = get_ave_s_o2_base();
+      observables[O2_BULK] = kinetics->nubs[nu];
+      observables[O2_BASE] = s;
       if (comm->me == 0 && screen) fprintf(screen, "S-o2-base = %e\n\n", s);
       if (comm->me == 0 && logfile) fprintf(logfile, "S-o2-base = %e\n\n", s);
     }
@@ -450,6 +474,8 @@ void FixVerify::bm3_output() {
       if (comm->me == 0 && screen) fprintf(screen, "S-sub-bulk = %e\n", kinetics->nubs[nu]);
       if (comm->me == 0 && logfile) fprintf(logfile, "S-sub-bulk = %e\n", kinetics->nubs[nu]);
       double s = get_ave_s_sub_base();
+      observables[SUB_BULK] = kinetics->nubs[nu];
+      observables[SUB_BASE] = s;
       if (comm->me == 0 && screen) fprintf(screen, "S-sub-base = %e\n", s);
       if (comm->me == 0 && logfile) fprintf(logfile, "S-sub-base = %e\n", s);
     }
@@ -458,6 +484,8 @@ void FixVerify::bm3_output() {
       if (comm->me == 0 && screen) fprintf(screen, "S-nh4-bulk = %e\n", kinetics->nubs[nu]);
       if (comm->me == 0 && logfile) fprintf(logfile, "S-nh4-bulk = %e\n", kinetics->nubs[nu]);
       double s = get_ave_s_nh4_base();
+      observables[NH4_BULK] = kinetics->nubs[nu];
+      observables[NH4_BASE] = s;
       if (comm->me == 0 && screen) fprintf(screen, "S-nh4-base = %e\n\n", s);
       if (comm->me == 0 && logfile) fprintf(logfile, "S-nh4-base = %e\n\n", s);
     }
@@ -536,6 +564,36 @@ double FixVerify::get_ave_s_nh4_base() {
   return global_ave_nh4_s/(kinetics->nx * kinetics->ny);
 }
 
+/* ----------------------------------------------------------------------
+ substrate uptake of the whole biofilm per unit substratum area
+ ------------------------------------------------------------------------- */
+
+void FixVerify::substrate_flux() {
+  int isub = 0;
+  for (int nu = 1; nu <= nnus; nu++)
+    if (strcmp(bio->nuname[nu], "sub") == 0) isub = nu;
+  if (!isub) return;
+
+  double uptake = 0;
+  for (int i = 0; i < kinetics->bgrids; i++)
+    uptake -= kinetics->nur[isub][i] * vol;
+
+  double global_uptake;
+  MPI_Allreduce(&uptake,&global_uptake,1,MPI_DOUBLE,MPI_SUM,world);
+
+  double area = (domain->boxhi[0] - domain->boxlo[0]) * (domain->boxhi[1] - domain->boxlo[1]);
+  observables[SUB_FLUX] = global_uptake / area;
+}
+
+/* ----------------------------------------------------------------------
+ benchmark observables, see the enum in fix_bio_verify.h
+ ------------------------------------------------------------------------- */
+
+double FixVerify::compute_vector(int n)
+{
+  return observables[n];
+}
+
 /* ---------------------------------------------------------------------- */
 
 int FixVerify::modify_param(int narg, char **arg)
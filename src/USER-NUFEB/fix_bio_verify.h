@@ -31,6 +31,11 @@ class FixVerify : public Fix {
   int setmask();
   void end_of_step();
   int modify_param(int, char **);
+  double compute_vector(int);
+
+  // benchmark observables, in the order of the output vector
+  enum {SUB_BULK, SUB_BASE, O2_BULK, O2_BASE, NH4_BULK, NH4_BASE,
+        SSURF, MAXZ, MASS, SUB_FLUX, N_BALANCE, NVERIFY};
 
  private:
 
@@ -51,6 +56,7 @@ class FixVerify : public Fix {
   double global_no2, global_pre_no2;
   double global_nh3, global_pre_nh3;
   double global_smass, global_pre_smass;
+  double observables[NVERIFY];      // last value of each benchmark observable
 
   class FixKinetics *kinetics;
   class BIO *bio;
@@ -70,6 +76,7 @@ class FixVerify : public Fix {
   double get_ave_s_nh4_base();
   void bm1_output();
   void bm3_output();
+  void substrate_flux();
   void benchmark_two();
   void benchmark_three();
   void remove_atom(double);
@@ -0,0 +1,210 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_GRID_NEIGHBOURS_H
+#define LMP_GRID_NEIGHBOURS_H
+
+#include "comm.h"
+#include "box.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace LAMMPS_NS {
+
+// tags reserved for the neighbour discovery messages
+enum {TAG_DISCOVER = 1001, TAG_REPLY = 1002, TAG_DISCOVER_NEXT = 1005};
+
+// fraction of a cell by which sample points are moved inside the cell
+static const double GRID_NEIGHBOUR_INSET = 1.0e-6;
+// value of Comm::layout for comm_style tiled
+static const int GRID_LAYOUT_TILED = 2;
+
+/* ----------------------------------------------------------------------
+   RCB tree of a tiled layout. CommTiled does not expose its cuts, so they
+   are gathered from the cut each rank owns the same way CommTiled::setup()
+   does; setup() is collective, callers keep the tree until the
+   decomposition changes
+------------------------------------------------------------------------- */
+
+class GridRCBTree {
+public:
+  void setup(Comm *comm, MPI_Comm world, const double *boxlo, const double *prd) {
+    int nprocs = comm->nprocs;
+    double one[2] = {comm->rcbcutfrac, (double)comm->rcbcutdim};
+    std::vector<double> all(2 * nprocs);
+    MPI_Allgather(one, 2, MPI_DOUBLE, all.data(), 2, MPI_DOUBLE, world);
+    cut.resize(nprocs);
+    dim.resize(nprocs);
+    for (int p = 0; p < nprocs; p++) {
+      dim[p] = static_cast<int>(all[2 * p + 1]);
+      cut[p] = boxlo[dim[p]] + prd[dim[p]] * all[2 * p];
+    }
+  }
+
+  // append the ranks whose subdomain overlaps [lo, hi] to procs
+  void owners(const double *lo, const double *hi, std::vector<int> &procs) const {
+    if (!cut.empty())
+      drop(lo, hi, 0, static_cast<int>(cut.size()) - 1, procs);
+  }
+
+private:
+  std::vector<double> cut;         // position of the cut owned by each rank
+  std::vector<int> dim;            // dimension of the cut owned by each rank
+
+  // same recursion as CommTiled::box_drop_tiled_recurse()
+  void drop(const double *lo, const double *hi, int proclower, int procupper,
+	    std::vector<int> &procs) const {
+    if (proclower == procupper) {
+      procs.push_back(proclower);
+      return;
+    }
+    int procmid = proclower + (procupper - proclower) / 2 + 1;
+    int d = dim[procmid];
+    if (lo[d] < cut[procmid])
+      drop(lo, hi, proclower, procmid - 1, procs);
+    if (hi[d] >= cut[procmid])
+      drop(lo, hi, procmid, procupper, procs);
+  }
+};
+
+/* ----------------------------------------------------------------------
+   append the ranks whose subdomain overlaps the cells of box, in grid
+   index space, to procs; the result is sorted and unique.
+   brick layouts look up the index ranges of the two corners in the
+   processor grid, tiled layouts drop the box down the tree, which must be
+   set up for the current decomposition, so the cost is O(ranks found)
+------------------------------------------------------------------------- */
+
+inline void grid_owners(Comm *comm, const GridRCBTree &tree, const double *origin,
+			const double *h, const Box<int, 3> &box, std::vector<int> &procs)
+{
+  for (int i = 0; i < 3; i++)
+    if (box.upper[i] <= box.lower[i]) return;
+
+  double lo[3], hi[3];
+  for (int i = 0; i < 3; i++) {
+    lo[i] = origin[i] + (box.lower[i] + GRID_NEIGHBOUR_INSET) * h[i];
+    hi[i] = origin[i] + (box.upper[i] - GRID_NEIGHBOUR_INSET) * h[i];
+  }
+
+  if (comm->layout != GRID_LAYOUT_TILED) {
+    int lo_ig[3], hi_ig[3];
+    comm->coord2proc(lo, lo_ig[0], lo_ig[1], lo_ig[2]);
+    comm->coord2proc(hi, hi_ig[0], hi_ig[1], hi_ig[2]);
+    for (int k = lo_ig[2]; k <= hi_ig[2]; k++)
+      for (int j = lo_ig[1]; j <= hi_ig[1]; j++)
+	for (int i = lo_ig[0]; i <= hi_ig[0]; i++)
+	  procs.push_back(comm->grid2proc[i][j][k]);
+  } else {
+    tree.owners(lo, hi, procs);
+  }
+
+  std::sort(procs.begin(), procs.end());
+  procs.erase(std::unique(procs.begin(), procs.end()), procs.end());
+}
+
+/* ----------------------------------------------------------------------
+   send len ints of msg to each rank in targets and return the ranks that
+   sent to us in sources with their messages in data. with MPI-3 this is
+   the non-blocking consensus (NBX) exchange and only talks to the ranks
+   involved, otherwise the # of incoming messages is found by a reduction
+------------------------------------------------------------------------- */
+
+inline void sparse_exchange(MPI_Comm world, const std::vector<int> &targets,
+			    const int *msg, int len,
+			    std::vector<int> &sources, std::vector<int> &data)
+{
+  sources.clear();
+  data.clear();
+  std::vector<int> buff(len);
+  MPI_Status status;
+
+  // consecutive exchanges alternate between two tags, so a message from a
+  // rank that has already moved on to the next exchange is not taken for
+  // one of this exchange; it cannot be two exchanges ahead, as every
+  // exchange ends with a collective
+  static int round = 0;
+  int tag = (round++ & 1) ? TAG_DISCOVER_NEXT : TAG_DISCOVER;
+
+#if MPI_VERSION >= 3
+  std::vector<MPI_Request> requests(targets.size());
+  for (size_t i = 0; i < targets.size(); i++)
+    MPI_Issend(const_cast<int *>(msg), len, MPI_INT, targets[i], tag, world, &requests[i]);
+
+  MPI_Request barrier = MPI_REQUEST_NULL;
+  bool barrier_active = false;
+  while (true) {
+    int flag;
+    MPI_Iprobe(MPI_ANY_SOURCE, tag, world, &flag, &status);
+    if (flag) {
+      MPI_Recv(buff.data(), len, MPI_INT, status.MPI_SOURCE, tag, world, MPI_STATUS_IGNORE);
+      sources.push_back(status.MPI_SOURCE);
+      data.insert(data.end(), buff.begin(), buff.end());
+    }
+    if (barrier_active) {
+      int done;
+      MPI_Test(&barrier, &done, MPI_STATUS_IGNORE);
+      if (done) break;
+    } else {
+      int sent;
+      MPI_Testall(requests.size(), requests.data(), &sent, MPI_STATUSES_IGNORE);
+      if (sent) {
+	MPI_Ibarrier(world, &barrier);
+	barrier_active = true;
+      }
+    }
+  }
+#else
+  int nprocs;
+  MPI_Comm_size(world, &nprocs);
+  std::vector<int> counts(nprocs, 0);
+  std::vector<int> ones(nprocs, 1);
+  for (size_t i = 0; i < targets.size(); i++)
+    counts[targets[i]] = 1;
+  int nrecv;
+  MPI_Reduce_scatter(counts.data(), &nrecv, ones.data(), MPI_INT, MPI_SUM, world);
+
+  std::vector<MPI_Request> requests(targets.size());
+  for (size_t i = 0; i < targets.size(); i++)
+    MPI_Isend(const_cast<int *>(msg), len, MPI_INT, targets[i], tag, world, &requests[i]);
+  for (int i = 0; i < nrecv; i++) {
+    MPI_Recv(buff.data(), len, MPI_INT, MPI_ANY_SOURCE, tag, world, &status);
+    sources.push_back(status.MPI_SOURCE);
+    data.insert(data.end(), buff.begin(), buff.end());
+  }
+  if (!requests.empty())
+    MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   point to point exchange of len ints with every rank in procs, which
+   must be symmetric, i.e. each rank in procs also lists this rank
+------------------------------------------------------------------------- */
+
+inline void neighbour_exchange(MPI_Comm world, const std::vector<int> &procs,
+			       const int *msg, int len, std::vector<int> &data)
+{
+  data.resize(procs.size() * len);
+  std::vector<MPI_Request> requests(2 * procs.size());
+  int nrequests = 0;
+  for (size_t i = 0; i < procs.size(); i++) {
+    MPI_Irecv(&data[i * len], len, MPI_INT, procs[i], TAG_REPLY, world, &requests[nrequests++]);
+    MPI_Isend(const_cast<int *>(msg), len, MPI_INT, procs[i], TAG_REPLY, world, &requests[nrequests++]);
+  }
+  if (nrequests > 0)
+    MPI_Waitall(nrequests, requests.data(), MPI_STATUSES_IGNORE);
+}
+
+}
+
+#endif // LMP_GRID_NEIGHBOURS_H
@@ -0,0 +1,277 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_GRID_PARTITION_H
+#define LMP_GRID_PARTITION_H
+
+#include "comm.h"
+#include "box.h"
+#include "grid_neighbours.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace LAMMPS_NS {
+
+// tags of the particle-grid redistribution messages
+enum {TAG_REDIST_COUNT = 1003, TAG_REDIST_DATA = 1004};
+
+/* ----------------------------------------------------------------------
+   brick partition of the kinetics grid, independent of the particle
+   decomposition. it uses the processor grid of comm, so that rank
+   grid2proc[i][j][k] owns the cells between cuts[d][i] and cuts[d][i+1].
+   cuts fall on multiples of block, the edge of the cubic blocks of cells
+   the grid is over-decomposed into, so moving a cut moves whole blocks
+------------------------------------------------------------------------- */
+
+class GridPartition {
+ public:
+  std::vector<int> cuts[3];         // grid plane of each cut [procgrid[d]+1]
+  int block;                        // # of cells along each edge of a block
+
+  GridPartition() : block(1) {}
+
+  bool operator==(const GridPartition &other) const {
+    for (int d = 0; d < 3; d++)
+      if (cuts[d] != other.cuts[d]) return false;
+    return true;
+  }
+  bool operator!=(const GridPartition &other) const { return !(*this == other); }
+
+  // # of blocks along dimension d, the last one may be partial
+  int nblocks(const int *n, int d) const { return (n[d] + block - 1) / block; }
+
+  // even x and y cuts, z cuts giving each layer the same # of the
+  // active planes [0, active), the top layer also taking those above
+  void balance(Comm *comm, const int *n, int active) {
+    for (int d = 0; d < 3; d++) {
+      int p = comm->procgrid[d];
+      int nb = nblocks(n, d);
+      int m = d == 2 ? (std::max(std::min(active, n[d]), 1) + block - 1) / block : nb;
+      cuts[d].resize(p + 1);
+      for (int i = 0; i < p; i++) {
+        int c = static_cast<int>(static_cast<double>(m) * i / p);
+        // keep at least one block per slab when possible
+        if (nb >= p) c = std::min(std::max(c, i), nb - (p - i));
+        cuts[d][i] = std::min(c * block, n[d]);
+      }
+      cuts[d][p] = n[d];
+    }
+  }
+
+  // cuts giving each slab of every dimension an equal share of the cost
+  // projected on that dimension, profile[d] holds the cost of each slab
+  // of blocks along d
+  void balance(Comm *comm, const int *n, const std::vector<double> *profile) {
+    for (int d = 0; d < 3; d++) {
+      int nb = nblocks(n, d);
+      double total = 0.0;
+      for (int i = 0; i < nb; i++) total += profile[d][i];
+
+      int p = comm->procgrid[d];
+      cuts[d].resize(p + 1);
+      cuts[d][0] = 0;
+      cuts[d][p] = n[d];
+      double sum = 0.0;
+      int c = 0;
+      int prev = 0;
+      for (int i = 1; i < p; i++) {
+        double target = total * i / p;
+        while (c < nb && sum + 0.5 * profile[d][c] < target) sum += profile[d][c++];
+        // keep at least one block per slab when possible
+        int cut = c;
+        if (nb >= p) cut = std::min(std::max(cut, prev + 1), nb - (p - i));
+        cuts[d][i] = std::min(cut * block, n[d]);
+        prev = cut;
+      }
+    }
+  }
+
+  Box<int, 3> box(int i, int j, int k) const {
+    return Box<int, 3>({cuts[0][i], cuts[1][j], cuts[2][k]},
+                       {cuts[0][i + 1], cuts[1][j + 1], cuts[2][k + 1]});
+  }
+
+  Box<int, 3> mybox(Comm *comm) const {
+    return box(comm->myloc[0], comm->myloc[1], comm->myloc[2]);
+  }
+
+  // slab of dimension d holding plane c
+  int slab(int d, int c) const {
+    return std::upper_bound(cuts[d].begin(), cuts[d].end() - 1, c) - cuts[d].begin() - 1;
+  }
+
+  int owner(Comm *comm, const int *cell) const {
+    return comm->grid2proc[slab(0, cell[0])][slab(1, cell[1])][slab(2, cell[2])];
+  }
+
+  // append the owners of the cells of a non-empty box to procs
+  void owners(Comm *comm, const Box<int, 3> &b, std::vector<int> &procs) const {
+    int lo[3], hi[3];
+    for (int d = 0; d < 3; d++) {
+      lo[d] = slab(d, b.lower[d]);
+      hi[d] = slab(d, b.upper[d] - 1);
+    }
+    for (int k = lo[2]; k <= hi[2]; k++)
+      for (int j = lo[1]; j <= hi[1]; j++)
+        for (int i = lo[0]; i <= hi[0]; i++)
+          procs.push_back(comm->grid2proc[i][j][k]);
+  }
+};
+
+/* ----------------------------------------------------------------------
+   as grid_owners() above, with the owners given by partition when it is
+   not NULL, i.e. when the grid has its own decomposition
+------------------------------------------------------------------------- */
+
+inline void grid_owners(Comm *comm, const GridPartition *partition, const GridRCBTree &tree,
+                        const double *origin, const double *h, const Box<int, 3> &box,
+                        std::vector<int> &procs)
+{
+  if (partition == NULL) {
+    grid_owners(comm, tree, origin, h, box, procs);
+    return;
+  }
+
+  for (int i = 0; i < 3; i++)
+    if (box.upper[i] <= box.lower[i]) return;
+
+  partition->owners(comm, box, procs);
+  std::sort(procs.begin(), procs.end());
+  procs.erase(std::unique(procs.begin(), procs.end()), procs.end());
+}
+
+/* ----------------------------------------------------------------------
+   redistribution between the particles of a rank and the cells they lie
+   in when those are owned by another rank. the values of the remote
+   cells are kept in columns [first, first + nremote) of the per-cell
+   arrays, after the columns of the local cells
+------------------------------------------------------------------------- */
+
+class GridRedist {
+ public:
+  std::vector<int> import_procs;    // owners of our remote cells
+  std::vector<int> import_begin;    // first remote cell of each owner [nimport+1]
+  std::vector<int> export_procs;    // ranks with particles in our cells
+  std::vector<int> export_begin;    // first export cell of each rank [nexport+1]
+  std::vector<int> export_cells;    // cells requested by export_procs
+
+  int nremote() const { return import_begin.empty() ? 0 : import_begin.back(); }
+
+  // procs and cells are the owner and id of each remote cell, sorted by
+  // owner. on return export_cells holds the ids requested from us, which
+  // the caller translates to local columns
+  void setup(MPI_Comm world, const std::vector<int> &procs, const std::vector<int> &cells) {
+    import_procs.clear();
+    import_begin.assign(1, 0);
+    for (size_t i = 0; i < procs.size(); i++) {
+      if (import_procs.empty() || import_procs.back() != procs[i]) {
+        import_procs.push_back(procs[i]);
+        import_begin.push_back(import_begin.back());
+      }
+      import_begin.back()++;
+    }
+
+    // learn who imports from us, then how many and which cells
+    int dummy = 0;
+    std::vector<int> data;
+    sparse_exchange(world, import_procs, &dummy, 1, export_procs, data);
+    std::sort(export_procs.begin(), export_procs.end());
+    int nimport = import_procs.size();
+    int nexport = export_procs.size();
+    std::vector<int> counts(nexport);
+    std::vector<MPI_Request> requests(nimport + nexport);
+    int nrequests = 0;
+    for (int n = 0; n < nexport; n++)
+      MPI_Irecv(&counts[n], 1, MPI_INT, export_procs[n], TAG_REDIST_COUNT, world, &requests[nrequests++]);
+    std::vector<int> sizes(nimport);
+    for (int n = 0; n < nimport; n++) {
+      sizes[n] = import_begin[n + 1] - import_begin[n];
+      MPI_Isend(&sizes[n], 1, MPI_INT, import_procs[n], TAG_REDIST_COUNT, world, &requests[nrequests++]);
+    }
+    if (nrequests > 0)
+      MPI_Waitall(nrequests, requests.data(), MPI_STATUSES_IGNORE);
+
+    export_begin.assign(nexport + 1, 0);
+    for (int n = 0; n < nexport; n++)
+      export_begin[n + 1] = export_begin[n] + counts[n];
+    export_cells.resize(export_begin[nexport]);
+    nrequests = 0;
+    for (int n = 0; n < nexport; n++)
+      if (counts[n] > 0)
+        MPI_Irecv(&export_cells[export_begin[n]], counts[n], MPI_INT, export_procs[n], TAG_REDIST_DATA, world, &requests[nrequests++]);
+    for (int n = 0; n < nimport; n++)
+      MPI_Isend(const_cast<int *>(&cells[import_begin[n]]), sizes[n], MPI_INT, import_procs[n], TAG_REDIST_DATA, world, &requests[nrequests++]);
+    if (nrequests > 0)
+      MPI_Waitall(nrequests, requests.data(), MPI_STATUSES_IGNORE);
+  }
+
+  // sum rows[r][first + s] of the remote cells into the owners' columns,
+  // rows is an array of nrows per-cell arrays
+  void reverse(MPI_Comm world, double **rows, int nrows, int first) {
+    int nimport = import_procs.size();
+    int nexport = export_procs.size();
+    send_buff.resize(nremote() * nrows);
+    recv_buff.resize(export_cells.size() * nrows);
+    for (int s = 0; s < nremote(); s++)
+      for (int r = 0; r < nrows; r++)
+        send_buff[s * nrows + r] = rows[r][first + s];
+
+    std::vector<MPI_Request> requests(nimport + nexport);
+    int nrequests = 0;
+    for (int n = 0; n < nexport; n++)
+      MPI_Irecv(&recv_buff[export_begin[n] * nrows], (export_begin[n + 1] - export_begin[n]) * nrows,
+                MPI_DOUBLE, export_procs[n], TAG_REDIST_DATA, world, &requests[nrequests++]);
+    for (int n = 0; n < nimport; n++)
+      MPI_Isend(&send_buff[import_begin[n] * nrows], (import_begin[n + 1] - import_begin[n]) * nrows,
+                MPI_DOUBLE, import_procs[n], TAG_REDIST_DATA, world, &requests[nrequests++]);
+    if (nrequests > 0)
+      MPI_Waitall(nrequests, requests.data(), MPI_STATUSES_IGNORE);
+
+    for (size_t k = 0; k < export_cells.size(); k++)
+      for (int r = 0; r < nrows; r++)
+        rows[r][export_cells[k]] += recv_buff[k * nrows + r];
+  }
+
+  // copy the owners' values of the remote cells to rows[r][first + s]
+  void forward(MPI_Comm world, double **rows, int nrows, int first) {
+    int nimport = import_procs.size();
+    int nexport = export_procs.size();
+    send_buff.resize(export_cells.size() * nrows);
+    recv_buff.resize(nremote() * nrows);
+    for (size_t k = 0; k < export_cells.size(); k++)
+      for (int r = 0; r < nrows; r++)
+        send_buff[k * nrows + r] = rows[r][export_cells[k]];
+
+    std::vector<MPI_Request> requests(nimport + nexport);
+    int nrequests = 0;
+    for (int n = 0; n < nimport; n++)
+      MPI_Irecv(&recv_buff[import_begin[n] * nrows], (import_begin[n + 1] - import_begin[n]) * nrows,
+                MPI_DOUBLE, import_procs[n], TAG_REDIST_DATA, world, &requests[nrequests++]);
+    for (int n = 0; n < nexport; n++)
+      MPI_Isend(&send_buff[export_begin[n] * nrows], (export_begin[n + 1] - export_begin[n]) * nrows,
+                MPI_DOUBLE, export_procs[n], TAG_REDIST_DATA, world, &requests[nrequests++]);
+    if (nrequests > 0)
+      MPI_Waitall(nrequests, requests.data(), MPI_STATUSES_IGNORE);
+
+    for (int s = 0; s < nremote(); s++)
+      for (int r = 0; r < nrows; r++)
+        rows[r][first + s] = recv_buff[s * nrows + r];
+  }
+
+ private:
+  std::vector<double> send_buff;
+  std::vector<double> recv_buff;
+};
+
+}
+
+#endif // LMP_GRID_PARTITION_H
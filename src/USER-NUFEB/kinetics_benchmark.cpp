@@ -0,0 +1,270 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#include "kinetics_benchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "atom.h"
+#include "atom_vec.h"
+#include "comm.h"
+#include "domain.h"
+#include "error.h"
+#include "force.h"
+#include "lammps.h"
+#include "memory.h"
+#include "modify.h"
+#include "update.h"
+
+#include "bio.h"
+#include "fix_bio_divide.h"
+#include "fix_bio_kinetics.h"
+#include "fix_bio_kinetics_diffusion.h"
+#include "fix_bio_kinetics_energy.h"
+#include "fix_bio_kinetics_matrix.h"
+#include "fix_bio_kinetics_monod.h"
+#include "fix_bio_kinetics_ph.h"
+#include "fix_bio_kinetics_thermo.h"
+
+using namespace LAMMPS_NS;
+
+// grid and unit flags of fix kinetics/diffusion
+enum{MOL, KG};
+enum{REGULAR, BOUNDARY, GHOST};
+
+/* ---------------------------------------------------------------------- */
+
+KineticsBenchmark::KineticsBenchmark(LAMMPS *lmp) : Pointers(lmp) {}
+
+/* ----------------------------------------------------------------------
+   kinetics/benchmark nrepeat file
+------------------------------------------------------------------------- */
+
+void KineticsBenchmark::command(int narg, char **arg)
+{
+  if (narg != 2) error->all(FLERR,"Illegal kinetics/benchmark command");
+  if (domain->box_exist == 0)
+    error->all(FLERR,"Kinetics/benchmark command before simulation box is defined");
+  if (update->whichflag != 0)
+    error->all(FLERR,"Kinetics/benchmark cannot be used during a run");
+
+  nrepeat = force->inumeric(FLERR,arg[0]);
+  if (nrepeat < 1) error->all(FLERR,"Illegal kinetics/benchmark command");
+
+  kinetics = NULL;
+  divide = NULL;
+  for (int j = 0; j < modify->nfix; j++) {
+    if (strcmp(modify->fix[j]->style,"kinetics") == 0)
+      kinetics = static_cast<FixKinetics *>(modify->fix[j]);
+    else if (strcmp(modify->fix[j]->style,"divide") == 0)
+      divide = static_cast<FixDivide *>(modify->fix[j]);
+  }
+  if (kinetics == NULL)
+    error->all(FLERR,"The fix kinetics command is required");
+
+  // set up grids and fixes as at the start of a run
+  lmp->init();
+
+  kinetics->update_bgrids();
+  kinetics->bin_atoms();
+  kinetics->update_xdensity();
+  kinetics->grow_flag = 0;
+
+  BIO *bio = kinetics->bio;
+  FixKineticsDiffusion *diffusion = kinetics->diffusion;
+  int nnus = bio->nnu;
+  int ntypes = atom->ntypes;
+  int nlocal = atom->nlocal;
+  double bgrids = kinetics->bgrids;
+  double dt = kinetics->diff_dt;
+
+  int nliq = 0;
+  for (int i = 1; i <= nnus; i++)
+    if (bio->nustate[i] == 0) nliq++;
+
+  if (comm->me == 0) {
+    if (screen) fprintf(screen,"Kinetics benchmark, %d calls per kernel:\n",nrepeat);
+    if (logfile) fprintf(logfile,"Kinetics benchmark, %d calls per kernel:\n",nrepeat);
+  }
+
+  results.clear();
+
+  // bytes are the compulsory reads and writes of grid arrays per call
+
+  if (diffusion != NULL) {
+    int *nuconv = new int[nnus + 1]();
+
+    time_kernel("diffusion", "cells", nrepeat, bgrids,
+                6.0 * sizeof(double) * nliq * bgrids, [&]() {
+      for (int i = 0; i <= nnus; i++) nuconv[i] = 0;
+      diffusion->diffusion(nuconv, dt);
+    });
+    delete[] nuconv;
+
+    double nboundary = 0;
+    for (int grid = 0; grid < diffusion->snxx_yy_zz; grid++)
+      if (diffusion->ghost[grid] == BOUNDARY) nboundary++;
+
+    time_kernel("compute_bc", "cells", nrepeat, nboundary,
+                3.0 * sizeof(double) * nliq * nboundary, [&]() {
+      for (int i = 1; i <= nnus; i++) {
+        if (bio->nustate[i] != 0) continue;
+        diffusion->set_bc(i);
+        double nubs = (diffusion->unit == MOL) ? kinetics->nubs[i] * 1000 : kinetics->nubs[i];
+        for (int grid = 0; grid < diffusion->snxx_yy_zz; grid++)
+          if (diffusion->ghost[grid] == BOUNDARY)
+            diffusion->compute_bc(diffusion->nugrid[i][grid], diffusion->nugrid[i], grid, nubs);
+      }
+    });
+
+    double *res;
+    memory->create(res, MAX(nliq * kinetics->bgrids, 1), "benchmark:res");
+    time_kernel("residual", "cells", nrepeat, bgrids,
+                3.0 * sizeof(double) * nliq * bgrids, [&]() {
+      diffusion->residual(res);
+    });
+    memory->destroy(res);
+
+    double nbuff = diffusion->buffer_size();
+    time_kernel("exchange", "cells", nrepeat, nbuff / nnus,
+                2.0 * sizeof(double) * nbuff, [&]() {
+      diffusion->DecompGrid<FixKineticsDiffusion>::exchange();
+    });
+  }
+
+  if (kinetics->ph != NULL) {
+    time_kernel("ph", "cells", nrepeat, bgrids,
+                (6.0 * nnus + 1) * sizeof(double) * bgrids, [&]() {
+      kinetics->ph->solve_ph();
+    });
+  }
+
+  if (kinetics->thermo != NULL) {
+    time_kernel("thermo", "cells", nrepeat, bgrids,
+                (5.0 * nnus + 3.0 * ntypes) * sizeof(double) * bgrids, [&]() {
+      kinetics->thermo->thermo(dt);
+    });
+  }
+
+  double growth_bytes = (2.0 * nnus + ntypes) * sizeof(double) * bgrids;
+  if (kinetics->energy != NULL) {
+    time_kernel("growth/energy", "cells", nrepeat, bgrids, growth_bytes, [&]() {
+      kinetics->energy->growth(dt, 0);
+    });
+  }
+  if (kinetics->monod != NULL) {
+    time_kernel("growth/monod", "cells", nrepeat, bgrids, growth_bytes, [&]() {
+      kinetics->monod->growth(dt, 0);
+    });
+  }
+  if (kinetics->matrix != NULL) {
+    time_kernel("growth/matrix", "cells", nrepeat, bgrids, growth_bytes, [&]() {
+      kinetics->matrix->growth(dt, 0);
+    });
+  }
+
+  time_kernel("bin_atoms", "atoms", nrepeat, nlocal,
+              (3.0 * sizeof(double) + 2.0 * sizeof(int)) * nlocal, [&]() {
+    kinetics->bin_atoms();
+  });
+
+  time_kernel("xdensity", "atoms", nrepeat, nlocal,
+              (2.0 * sizeof(double) + sizeof(int)) * nlocal +
+              (ntypes + 1.0) * sizeof(double) * bgrids, [&]() {
+    kinetics->update_xdensity();
+  });
+
+  // division inserts atoms, so it runs once and goes last; the # of
+  // inserted atoms is only known afterwards
+  if (divide != NULL) {
+    bigint natoms = atom->natoms;
+    time_kernel("divide", "atoms", 1, 0.0, 0.0, [&]() {
+      divide->post_integrate();
+    });
+    Result &r = results.back();
+    r.items = (double) (atom->natoms - natoms);
+    r.bytes = r.items * 2.0 * atom->avec->size_border * sizeof(double);
+    kinetics->bin_atoms();
+  }
+
+  write_json(arg[1]);
+}
+
+/* ----------------------------------------------------------------------
+   call f ncalls times after one untimed warm-up call, except for single
+   calls, and record the slowest proc
+------------------------------------------------------------------------- */
+
+template <class F>
+void KineticsBenchmark::time_kernel(const char *name, const char *unit, int ncalls,
+                                    double items, double bytes, F f)
+{
+  if (ncalls > 1) f();
+
+  MPI_Barrier(world);
+  double t0 = MPI_Wtime();
+  for (int n = 0; n < ncalls; n++) f();
+  double dt = (MPI_Wtime() - t0) / ncalls;
+
+  Result r;
+  r.name = name;
+  r.unit = unit;
+  r.calls = ncalls;
+  MPI_Allreduce(&dt, &r.time, 1, MPI_DOUBLE, MPI_MAX, world);
+  MPI_Allreduce(&items, &r.items, 1, MPI_DOUBLE, MPI_SUM, world);
+  MPI_Allreduce(&bytes, &r.bytes, 1, MPI_DOUBLE, MPI_SUM, world);
+  results.push_back(r);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void KineticsBenchmark::write_json(const char *file)
+{
+  if (comm->me != 0) return;
+
+  FILE *out[2] = {screen, logfile};
+  for (int f = 0; f < 2; f++) {
+    if (out[f] == NULL) continue;
+    for (size_t k = 0; k < results.size(); k++) {
+      Result &r = results[k];
+      double rate = r.time > 0.0 ? r.items / r.time : 0.0;
+      double bw = r.time > 0.0 ? r.bytes / r.time * 1.0e-9 : 0.0;
+      fprintf(out[f],"  %-14s %10.4g s/call %10.4g %s/s %8.3f GB/s\n",
+              r.name.c_str(), r.time, rate, r.unit.c_str(), bw);
+    }
+  }
+
+  FILE *fp = fopen(file,"w");
+  if (fp == NULL) error->one(FLERR,"Cannot open kinetics/benchmark output file");
+
+  fprintf(fp,"{\n");
+  fprintf(fp,"  \"nprocs\": %d,\n",comm->nprocs);
+  fprintf(fp,"  \"nthreads\": %d,\n",comm->nthreads);
+  fprintf(fp,"  \"grid\": [%d, %d, %d],\n",kinetics->nx,kinetics->ny,kinetics->nz);
+  fprintf(fp,"  \"nutrients\": %d,\n",kinetics->bio->nnu);
+  fprintf(fp,"  \"types\": %d,\n",atom->ntypes);
+  fprintf(fp,"  \"atoms\": " BIGINT_FORMAT ",\n",atom->natoms);
+  fprintf(fp,"  \"repeat\": %d,\n",nrepeat);
+  fprintf(fp,"  \"kernels\": [\n");
+  for (size_t k = 0; k < results.size(); k++) {
+    Result &r = results[k];
+    double rate = r.time > 0.0 ? r.items / r.time : 0.0;
+    double bw = r.time > 0.0 ? r.bytes / r.time * 1.0e-9 : 0.0;
+    fprintf(fp,"    {\"name\": \"%s\", \"unit\": \"%s\", \"calls\": %d, "
+            "\"time_per_call\": %.6e, \"items_per_call\": %.6e, "
+            "\"items_per_s\": %.6e, \"bytes_per_call\": %.6e, \"gb_per_s\": %.6e}%s\n",
+            r.name.c_str(), r.unit.c_str(), r.calls, r.time, r.items,
+            rate, r.bytes, bw, k + 1 < results.size() ? "," : "");
+  }
+  fprintf(fp,"  ]\n}\n");
+  fclose(fp);
+}
@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifdef COMMAND_CLASS
+
+CommandStyle(kinetics/benchmark,KineticsBenchmark)
+
+#else
+
+#ifndef LMP_KINETICS_BENCHMARK_H
+#define LMP_KINETICS_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// Times the NUFEB kernels one at a time on the grids and atoms set up by
+// the input script, outside of a run. Each kernel reports the # of cells
+// (or atoms) it processed per second and an estimate of the memory traffic
+// it needs, and the results are written to a JSON file.
+
+class KineticsBenchmark : protected Pointers {
+ public:
+  KineticsBenchmark(class LAMMPS *);
+  void command(int, char **);
+
+ private:
+  struct Result {
+    std::string name;
+    std::string unit;              // what items counts, cells or atoms
+    int calls;
+    double time;                   // wall time per call, max over procs
+    double items;                  // items per call, summed over procs
+    double bytes;                  // estimated bytes per call, summed over procs
+  };
+
+  int nrepeat;
+  std::vector<Result> results;
+
+  class FixKinetics *kinetics;
+  class FixDivide *divide;
+
+  template <class F>
+  void time_kernel(const char *, const char *, int, double, double, F);
+  void write_json(const char *);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal kinetics/benchmark command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Kinetics/benchmark command before simulation box is defined
+
+Self-explanatory.
+
+E: The fix kinetics command is required
+
+Kinetics/benchmark times the kernels of the fixes attached to fix kinetics.
+
+E: Kinetics/benchmark cannot be used during a run
+
+Self-explanatory.
+
+E: Cannot open kinetics/benchmark output file
+
+The output file could not be opened.  Check that the path and name are
+correct.
+
+*/
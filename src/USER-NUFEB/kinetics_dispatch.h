@@ -0,0 +1,32 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifndef SRC_KINETICS_DISPATCH_H
+#define SRC_KINETICS_DISPATCH_H
+
+// Hot kinetics kernels are templates on the number of nutrients NNU and
+// use NNU > 0 ? NNU : bio->nnu as loop bound, so that the inner nutrient
+// loops can be fully unrolled. NNU = 0 is the generic instantiation, used
+// for nutrient counts not listed below.
+//
+// Dispatch with an X-macro, e.g.
+//
+//   #define KERNEL_CASE(N) case N: fn = &Class::kernel<N>; break;
+//   switch (nnu) {
+//   NUFEB_NNU_CASES(KERNEL_CASE)
+//   default: fn = &Class::kernel<0>;
+//   }
+//   #undef KERNEL_CASE
+
+#define NUFEB_NNU_CASES(X) \
+  X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(12)
+
+#endif
@@ -0,0 +1,303 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#include "newton_krylov.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "bio.h"
+#include "bio_timer.h"
+#include "comm.h"
+#include "fix_bio_kinetics.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+#define GMRES_CYCLES 10        // max # of GMRES restarts per Newton step
+#define LINE_SEARCH 8          // max # of step halvings
+#define FORCING 0.1            // relative GMRES tolerance of a Newton step
+
+/* ---------------------------------------------------------------------- */
+
+NewtonKrylov::NewtonKrylov(LAMMPS *lmp, FixKinetics *kinetics, int restart) : Pointers(lmp)
+{
+  this->kinetics = kinetics;
+  this->restart = restart;
+  n = nmax = 0;
+  nevals = 0;
+
+  scale = y = f = yp = fp = dy = r = w = NULL;
+  v = NULL;
+
+  memory->create(h, (restart + 1) * restart, "jfnk:h");
+  memory->create(cs, restart, "jfnk:cs");
+  memory->create(sn, restart, "jfnk:sn");
+  memory->create(g, restart + 1, "jfnk:g");
+}
+
+/* ---------------------------------------------------------------------- */
+
+NewtonKrylov::~NewtonKrylov()
+{
+  memory->destroy(scale);
+  memory->destroy(y);
+  memory->destroy(f);
+  memory->destroy(yp);
+  memory->destroy(fp);
+  memory->destroy(dy);
+  memory->destroy(r);
+  memory->destroy(w);
+  memory->destroy(v);
+  memory->destroy(h);
+  memory->destroy(cs);
+  memory->destroy(sn);
+  memory->destroy(g);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void NewtonKrylov::grow(int nlocal)
+{
+  n = nlocal;
+  if (n <= nmax) return;
+  nmax = n;
+  memory->destroy(scale);
+  memory->destroy(y);
+  memory->destroy(f);
+  memory->destroy(yp);
+  memory->destroy(fp);
+  memory->destroy(dy);
+  memory->destroy(r);
+  memory->destroy(w);
+  memory->destroy(v);
+  memory->create(scale, nmax, "jfnk:scale");
+  memory->create(y, nmax, "jfnk:y");
+  memory->create(f, nmax, "jfnk:f");
+  memory->create(yp, nmax, "jfnk:yp");
+  memory->create(fp, nmax, "jfnk:fp");
+  memory->create(dy, nmax, "jfnk:dy");
+  memory->create(r, nmax, "jfnk:r");
+  memory->create(w, nmax, "jfnk:w");
+  memory->create(v, restart + 1, nmax, "jfnk:v");
+}
+
+/* ----------------------------------------------------------------------
+ solve for the packed concentrations x of n local entries, return the #
+ of Newton iterations; x holds the solution on return
+ ------------------------------------------------------------------------- */
+
+int NewtonKrylov::solve(double *x, int nlocal, double tol, int maxit)
+{
+  grow(nlocal);
+  compute_scale(x);
+  nevals = 0;
+
+  for (int i = 0; i < n; i++) y[i] = x[i] / scale[i];
+  residual(y, f);
+  double fnorm = norm(f);
+  double fnorm0 = fnorm;
+
+  int it = 0;
+  while (it < maxit && fnorm > tol * fnorm0 && fnorm > 0.0) {
+    it++;
+
+    gmres(fnorm, FORCING);
+
+    // backtracking line search on the residual norm
+    double lambda = 1.0;
+    double fpnorm = 0.0;
+    int ls;
+    for (ls = 0; ls < LINE_SEARCH; ls++) {
+      for (int i = 0; i < n; i++) yp[i] = y[i] + lambda * dy[i];
+      residual(yp, fp);
+      fpnorm = norm(fp);
+      if (fpnorm < (1.0 - 1e-4 * lambda) * fnorm) break;
+      lambda *= 0.5;
+    }
+    if (ls == LINE_SEARCH) break;
+
+    double *t = y; y = yp; yp = t;
+    t = f; f = fp; fp = t;
+    fnorm = fpnorm;
+  }
+
+  for (int i = 0; i < n; i++) x[i] = y[i] * scale[i];
+
+  if (comm->me == 0 && logfile)
+    fprintf(logfile, "number of residual evaluations: %i relative residual: %e \n",
+            nevals, fnorm0 > 0.0 ? fnorm / fnorm0 : 0.0);
+  if (comm->me == 0 && screen)
+    fprintf(screen, "number of residual evaluations: %i relative residual: %e \n",
+            nevals, fnorm0 > 0.0 ? fnorm / fnorm0 : 0.0);
+
+  return it;
+}
+
+/* ----------------------------------------------------------------------
+ scale each nutrient block by the largest concentration of the nutrient
+ ------------------------------------------------------------------------- */
+
+void NewtonKrylov::compute_scale(const double *x)
+{
+  int nliq = 0;
+  BIO *bio = kinetics->bio;
+  for (int nu = 1; nu <= bio->nnu; nu++)
+    if (bio->nustate[nu] == 0) nliq++;
+
+  int bgrids = kinetics->bgrids;
+  double *local = new double[nliq];
+  double *global = new double[nliq];
+
+  for (int k = 0; k < nliq; k++) {
+    local[k] = 0.0;
+    for (int j = 0; j < bgrids; j++)
+      local[k] = fmax(local[k], fabs(x[k * bgrids + j]));
+  }
+  MPI_Allreduce(local, global, nliq, MPI_DOUBLE, MPI_MAX, world);
+
+  for (int k = 0; k < nliq; k++) {
+    double s = global[k] > 0.0 ? global[k] : 1.0;
+    for (int j = 0; j < bgrids; j++)
+      scale[k * bgrids + j] = s;
+  }
+
+  delete[] local;
+  delete[] global;
+}
+
+/* ----------------------------------------------------------------------
+ scaled residual at the scaled iterate ys; reactions are evaluated
+ without gas-liquid transfer so that repeated evaluations are consistent
+ ------------------------------------------------------------------------- */
+
+void NewtonKrylov::residual(const double *ys, double *fs)
+{
+  for (int i = 0; i < n; i++) w[i] = ys[i] * scale[i];
+  kinetics->coupling_residual(w, fs, 0.0);
+  for (int i = 0; i < n; i++) fs[i] /= scale[i];
+  nevals++;
+}
+
+/* ----------------------------------------------------------------------
+ finite difference approximation of J(ys) u, given fs = F(ys)
+ ------------------------------------------------------------------------- */
+
+void NewtonKrylov::jacobian(const double *ys, const double *fs, double ynorm, const double *u, double *ju)
+{
+  double unorm = norm(u);
+  if (unorm == 0.0) {
+    for (int i = 0; i < n; i++) ju[i] = 0.0;
+    return;
+  }
+  double eps = sqrt(2.2e-16) * (1.0 + ynorm) / unorm;
+
+  for (int i = 0; i < n; i++) yp[i] = ys[i] + eps * u[i];
+  residual(yp, ju);
+  for (int i = 0; i < n; i++) ju[i] = (ju[i] - fs[i]) / eps;
+}
+
+/* ----------------------------------------------------------------------
+ restarted GMRES for J dy = -f to relative tolerance eta, starting from
+ dy = 0; return the # of Krylov iterations
+ ------------------------------------------------------------------------- */
+
+int NewtonKrylov::gmres(double fnorm, double eta)
+{
+  double ynorm = norm(y);
+  double target = eta * fnorm;
+  int total = 0;
+
+  for (int i = 0; i < n; i++) {
+    dy[i] = 0.0;
+    r[i] = -f[i];
+  }
+  double beta = fnorm;
+
+  for (int cycle = 0; cycle < GMRES_CYCLES && beta > target; cycle++) {
+    for (int i = 0; i < n; i++) v[0][i] = r[i] / beta;
+    g[0] = beta;
+    for (int j = 1; j <= restart; j++) g[j] = 0.0;
+
+    int k = 0;
+    double resid = beta;
+    while (k < restart && resid > target) {
+      jacobian(y, f, ynorm, v[k], v[k + 1]);
+      total++;
+
+      // modified Gram-Schmidt
+      for (int i = 0; i <= k; i++) {
+        double hik = dot(v[k + 1], v[i]);
+        h[i * restart + k] = hik;
+        for (int l = 0; l < n; l++) v[k + 1][l] -= hik * v[i][l];
+      }
+      double hk1 = norm(v[k + 1]);
+      if (hk1 > 0.0)
+        for (int l = 0; l < n; l++) v[k + 1][l] /= hk1;
+
+      // apply previous rotations, then eliminate h(k+1,k)
+      for (int i = 0; i < k; i++) {
+        double a = h[i * restart + k];
+        double b = h[(i + 1) * restart + k];
+        h[i * restart + k] = cs[i] * a + sn[i] * b;
+        h[(i + 1) * restart + k] = -sn[i] * a + cs[i] * b;
+      }
+      double a = h[k * restart + k];
+      double d = sqrt(a * a + hk1 * hk1);
+      cs[k] = d > 0.0 ? a / d : 1.0;
+      sn[k] = d > 0.0 ? hk1 / d : 0.0;
+      h[k * restart + k] = d;
+      g[k + 1] = -sn[k] * g[k];
+      g[k] = cs[k] * g[k];
+      resid = fabs(g[k + 1]);
+      k++;
+
+      if (hk1 == 0.0) break;
+    }
+
+    // back substitution and update of the step
+    for (int i = k - 1; i >= 0; i--) {
+      double sum = g[i];
+      for (int j = i + 1; j < k; j++) sum -= h[i * restart + j] * g[j];
+      g[i] = h[i * restart + i] != 0.0 ? sum / h[i * restart + i] : 0.0;
+    }
+    for (int i = 0; i < k; i++)
+      for (int l = 0; l < n; l++) dy[l] += g[i] * v[i][l];
+
+    if (resid <= target) break;
+
+    // true residual for the restart
+    jacobian(y, f, ynorm, dy, r);
+    for (int l = 0; l < n; l++) r[l] = -f[l] - r[l];
+    beta = norm(r);
+  }
+
+  return total;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double NewtonKrylov::dot(const double *a, const double *b)
+{
+  double local = 0.0, global;
+  for (int i = 0; i < n; i++) local += a[i] * b[i];
+  kinetics->bio->timer->start(BioTimer::REDUCE);
+  MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_SUM, world);
+  kinetics->bio->timer->stop(BioTimer::REDUCE);
+  return global;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double NewtonKrylov::norm(const double *a)
+{
+  return sqrt(dot(a, a));
+}
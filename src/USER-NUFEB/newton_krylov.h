@@ -0,0 +1,64 @@
+/* ----------------------------------------------------------------------
+   NUFEB package - A LAMMPS user package for Individual-based Modelling of Microbial Communities
+   Contributing authors: Bowen Li & Denis Taniguchi (Newcastle University, UK)
+   Email: bowen.li2@newcastle.ac.uk & denis.taniguchi@newcastle.ac.uk
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+------------------------------------------------------------------------- */
+
+#ifndef SRC_NEWTON_KRYLOV_H
+#define SRC_NEWTON_KRYLOV_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// Jacobian-free Newton-Krylov solver for the steady reaction-diffusion
+// equations of fix kinetics.
+//
+// The unknowns are the liquid nutrient concentrations packed by
+// FixKinetics::pack_nus(). Residuals come from
+// FixKinetics::coupling_residual(), and Jacobian-vector products are
+// finite differences of the residual. Each Newton step is solved with
+// restarted GMRES and followed by a backtracking line search. Unknowns
+// and residuals are scaled per nutrient by the largest concentration of
+// that nutrient, so that nutrients of very different magnitude converge
+// together.
+
+class NewtonKrylov : protected Pointers {
+ public:
+  NewtonKrylov(class LAMMPS *, class FixKinetics *, int);
+  ~NewtonKrylov();
+  int solve(double *, int, double, int);
+  int get_nevals() const { return nevals; }
+
+ private:
+  class FixKinetics *kinetics;
+  int restart;                // GMRES restart length
+  int n, nmax;                // # of local unknowns and allocated size
+  int nevals;                 // # of residual evaluations in the last solve
+
+  double *scale;              // per-unknown scaling factor
+  double *y, *f;              // scaled iterate and residual
+  double *yp, *fp;            // trial iterate and residual
+  double *dy;                 // Newton step
+  double *r, *w;              // GMRES work vectors
+  double **v;                 // Krylov basis [restart+1][n]
+  double *h;                  // Hessenberg matrix [(restart+1)*restart]
+  double *cs, *sn, *g;        // Givens rotations and rotated rhs
+
+  void grow(int);
+  void compute_scale(const double *);
+  void residual(const double *, double *);
+  void jacobian(const double *, const double *, double, const double *, double *);
+  int gmres(double, double);
+  double dot(const double *, const double *);
+  double norm(const double *);
+};
+
+}
+
+#endif
@@ -13,6 +13,7 @@
 #define LMP_REDUCE_GRID_H
 
 #include "subgrid.h"
+#include "grid_neighbours.h"
 
 #include <vector>
 
@@ -22,46 +23,66 @@ class ReduceGrid {
 public:
   void setup() {
     Derived *derived = static_cast<Derived *>(this);
-    // communicate grid extent
     Subgrid<double, 2> subgrid = derived->get_subgrid();
     Box<int, 2> box = subgrid.get_box();
-    std::vector<int> boxlo(2 * derived->comm->nprocs);
-    MPI_Allgather(&box.lower[0], 2, MPI_INT, boxlo.data(), 2, MPI_INT, derived->world);
-    std::vector<int> boxhi(2 * derived->comm->nprocs);
-    MPI_Allgather(&box.upper[0], 2, MPI_INT, boxhi.data(), 2, MPI_INT, derived->world);
-    std::vector<double> sublo_z(derived->comm->nprocs);
-    MPI_Allgather(&derived->domain->sublo[2], 1, MPI_DOUBLE, sublo_z.data(), 1, MPI_DOUBLE, derived->world);
+    int me = derived->comm->me;
+    int bottom = derived->domain->sublo[2] == derived->domain->boxlo[2];
+
+    // procs above the bottom layer send to the bottom procs below their
+    // columns, which learn about them from the sparse exchange
+    std::vector<int> targets;
+    // the tree is set up collectively, before only some procs use it
+    if (derived->comm->layout == GRID_LAYOUT_TILED)
+      tree.setup(derived->comm, derived->world, derived->domain->boxlo, derived->domain->prd);
+    if (!bottom) {
+      const std::array<double, 2> &h2 = subgrid.get_grid().get_cell_size();
+      const std::array<double, 2> &o2 = subgrid.get_grid().get_origin();
+      // a zero height cell samples the bottom face of our columns
+      double origin[3] = {o2[0], o2[1], derived->domain->boxlo[2]};
+      double h[3] = {h2[0], h2[1], 0.0};
+      Box<int, 3> base({box.lower[0], box.lower[1], 0}, {box.upper[0], box.upper[1], 1});
+      grid_owners(derived->comm, tree, origin, h, base, targets);
+      targets.erase(std::remove(targets.begin(), targets.end(), me), targets.end());
+    }
+    int msg[5] = {box.lower[0], box.lower[1], box.upper[0], box.upper[1], bottom};
+    std::vector<int> sources, data;
+    sparse_exchange(derived->world, targets, msg, 5, sources, data);
+    neighbours = targets;
+    neighbours.insert(neighbours.end(), sources.begin(), sources.end());
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    std::vector<int> boxes;
+    neighbour_exchange(derived->world, neighbours, msg, 5, boxes);
 
     clear();
-    recv_begin.resize(derived->comm->nprocs);
-    send_begin.resize(derived->comm->nprocs);
-    recv_end.resize(derived->comm->nprocs);
-    send_end.resize(derived->comm->nprocs);
-    requests.resize(derived->comm->nprocs);
+    int nneighs = neighbours.size();
+    recv_begin.resize(nneighs);
+    send_begin.resize(nneighs);
+    recv_end.resize(nneighs);
+    send_end.resize(nneighs);
+    requests.resize(nneighs);
     // look for intersections
     int nrecv = 0;
     int nsend = 0;
-    int me = derived->comm->me;
-    for (int p = 0; p < derived->comm->nprocs; p++) {
-      recv_begin[p] = nrecv;
-      send_begin[p] = nsend;
-      Box<int, 2> other(&boxlo[2 * p], &boxhi[2 * p]);
-      if (p != me) {
-        // identify which cells we need to recv if we are the bottom most proc
-        Box<int, 2> intersection = intersect(box, other);
-        int n = cell_count(intersection);
-        if (n > 0 && sublo_z[me] == derived->domain->boxlo[2] && sublo_z[p] != derived->domain->boxlo[2]) {
-          add_cells(subgrid, intersection, recv_cells);
-          nrecv += n;
-        }
-        // identify which cells we need to send if we are not the bottom most proc
-        if (n > 0 && sublo_z[me] != derived->domain->boxlo[2] && sublo_z[p] == derived->domain->boxlo[2]) {
-          add_cells(subgrid, intersection, send_cells);
-          nsend += n;
-        }
+    for (int k = 0; k < nneighs; k++) {
+      recv_begin[k] = nrecv;
+      send_begin[k] = nsend;
+      Box<int, 2> other(&boxes[5 * k], &boxes[5 * k + 2]);
+      int other_bottom = boxes[5 * k + 4];
+      // identify which cells we need to recv if we are the bottom most proc
+      Box<int, 2> intersection = intersect(box, other);
+      int n = cell_count(intersection);
+      if (n > 0 && bottom && !other_bottom) {
+        add_cells(subgrid, intersection, recv_cells);
+        nrecv += n;
+      }
+      // identify which cells we need to send if we are not the bottom most proc
+      if (n > 0 && !bottom && other_bottom) {
+        add_cells(subgrid, intersection, send_cells);
+        nsend += n;
       }
-      recv_end[p] = nrecv;
-      send_end[p] = nsend;
+      recv_end[k] = nrecv;
+      send_end[k] = nsend;
     }
     recv_buff.resize(derived->get_cell_data_size(nrecv));
     send_buff.resize(derived->get_cell_data_size(nsend));
@@ -72,13 +93,11 @@ public:
     int nrequests = 0;
     int recv_offset = 0;
     int send_offset = 0;
-    for (int p = 0; p < derived->comm->nprocs; p++) {
-      if (p == derived->comm->me)
-        continue;
-      int nrecv = recv_end[p] - recv_begin[p];
+    for (size_t k = 0; k < neighbours.size(); k++) {
+      int nrecv = recv_end[k] - recv_begin[k];
       if (nrecv > 0) {
         int count = derived->get_cell_data_size(nrecv);
-        MPI_Irecv(&recv_buff[recv_offset], count, MPI_DOUBLE, p, 0, derived->world, &requests[nrequests++]);
+        MPI_Irecv(&recv_buff[recv_offset], count, MPI_DOUBLE, neighbours[k], 0, derived->world, &requests[nrequests++]);
         recv_offset += count;
       }
     }
@@ -88,13 +107,11 @@ public:
     }
     // pack data to send buffer
     derived->pack_cells(send_cells.begin(), send_cells.end(), send_buff.begin());
-    for (int p = 0; p < derived->comm->nprocs; p++) {
-      if (p == derived->comm->me)
-        continue;
-      int nsend = send_end[p] - send_begin[p];
+    for (size_t k = 0; k < neighbours.size(); k++) {
+      int nsend = send_end[k] - send_begin[k];
       if (nsend > 0) {
         int count = derived->get_cell_data_size(nsend);
-        MPI_Send(&send_buff[send_offset], count, MPI_DOUBLE, p, 0, derived->world);
+        MPI_Send(&send_buff[send_offset], count, MPI_DOUBLE, neighbours[k], 0, derived->world);
         send_offset += count;
       }
     }
@@ -128,6 +145,8 @@ private:
 
   Grid<double, 3> grid;
   Grid<double, 3> subgrid;
+  GridRCBTree tree;                 // RCB tree of a tiled layout
+  std::vector<int> neighbours;      // procs in the same columns across the bottom layer
   std::vector<int> recv_cells;
   std::vector<int> send_cells;
   std::vector<int> recv_begin;
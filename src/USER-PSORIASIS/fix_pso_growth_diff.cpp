@@ -272,7 +272,6 @@ void FixPGrowthDIFF::growth(double dt, int gflag) {
 
   const double three_quarters_pi = (3.0 / (4.0 * MY_PI));
   const double four_thirds_pi = 4.0 * MY_PI / 3.0;
-  const double third = 1.0 / 3.0;
 
   double growrate_d = 0;
 
@@ -282,7 +281,7 @@ void FixPGrowthDIFF::growth(double dt, int gflag) {
   for (int i = 0; i < nlocal; i++) {
 	if (mask[i] & groupbit) {
 	  int t = type[i];
-	  int grid = kinetics->position(i); //find grid that atom is in
+	  int grid = kinetics->atom_cell[i]; //find grid that atom is in
 
 	  double density = rmass[i] / (four_thirds_pi * radius[i] * radius[i] * radius[i]);
 
@@ -309,7 +308,7 @@ void FixPGrowthDIFF::growth(double dt, int gflag) {
         	rmass[i] = rmass[i];
 
 		printf("rmass diff cell %i is now %e\n", i, rmass[i]);
-		radius[i] = pow(three_quarters_pi * (rmass[i] / density), third);
+		radius[i] = cbrt(three_quarters_pi * (rmass[i] / density));
 		printf("radius diff cell %i is now %e\n", i, radius[i]);
         //outer mass & radius is for sc to ta
 		outer_mass[i] = rmass[i];
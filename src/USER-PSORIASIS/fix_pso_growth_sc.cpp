@@ -278,7 +278,6 @@ void FixPGrowthSC::growth(double dt, int gflag) {
 
   const double three_quarters_pi = (3.0 / (4.0 * MY_PI));
   const double four_thirds_pi = 4.0 * MY_PI / 3.0;
-  const double third = 1.0 / 3.0;
 
   double growrate_sc = 0;
   double growrate_ta = 0; //sc can divide to a TA cell
@@ -289,7 +288,7 @@ void FixPGrowthSC::growth(double dt, int gflag) {
   for (int i = 0; i < nlocal; i++) {
 	if (mask[i] & groupbit) {
 	  int t = type[i];
-	  int grid = kinetics->position(i); //find grid that atom is in
+	  int grid = kinetics->atom_cell[i]; //find grid that atom is in
 
 	  double density = rmass[i] / (four_thirds_pi * radius[i] * radius[i] * radius[i]);
 
@@ -317,12 +316,12 @@ void FixPGrowthSC::growth(double dt, int gflag) {
 		//rmass[i] = rmass[i] + (growrate_sc - growrate_ta) * rmass[i] * dt;
         rmass[i] = rmass[i] + rmass[i] * (1 + (growrate_sc - growrate_ta) * dt);
 		//printf("rmass is now %e\n", rmass[i]);
-		radius[i] = pow(three_quarters_pi * (rmass[i] / density), third);
+		radius[i] = cbrt(three_quarters_pi * (rmass[i] / density));
 		//printf("radius  is now %e\n", radius[i]);
         //outer mass & radius is for sc to ta
 		outer_mass[i] = four_thirds_pi * (outer_radius[i] * outer_radius[i] * outer_radius[i] - radius[i] * radius[i] * radius[i]) * sc_dens + growrate_ta * rmass[i] * dt;
 		//printf("outer mass is %e\n", outer_mass[i]);
-		outer_radius[i] =  pow(three_quarters_pi * (rmass[i] / density + outer_mass[i] / sc_dens), third);
+		outer_radius[i] =  cbrt(three_quarters_pi * (rmass[i] / density + outer_mass[i] / sc_dens));
 		//printf("outer radius is %e\n", outer_radius[i]);
       }
     }
@@ -355,17 +354,16 @@ double FixPGrowthSC::calculate_gridmass(int grid_id){ // to edit
 int FixPGrowthSC::calculate_gridcell(int grid_id, int t){
 	int cell_count = 0;
 	int *mask = atom->mask;
-	int nlocal = atom->nlocal;
 	int *type = atom->type;
 
-	for (int i = 0; i < nlocal; i++) {
-		if (mask[i] & groupbit) {
-			int pos = kinetics->position(i);
-
-			//if it is within the same grid and is the targeted cell type, add 1
-			if (pos == grid_id && t == type[i]){
-				cell_count += 1;
-			}
+	// only the atoms binned to grid_id need to be visited
+	kinetics->update_bins();
+	int *cell_atoms = kinetics->cell_atoms;
+	for (int j = kinetics->cell_start[grid_id]; j < kinetics->cell_start[grid_id + 1]; j++) {
+		int i = cell_atoms[j];
+		//if it is the targeted cell type, add 1
+		if ((mask[i] & groupbit) && t == type[i]){
+			cell_count += 1;
 		}
 	}
 //	printf("type: %i cell count in grid %d is %d \n", t, grid_id, cell_count);
@@ -283,7 +283,6 @@ void FixPGrowthTA::growth(double dt, int gflag) {
 
   const double three_quarters_pi = (3.0 / (4.0 * MY_PI));
   const double four_thirds_pi = 4.0 * MY_PI / 3.0;
-  const double third = 1.0 / 3.0;
 
   double growrate_d = 0;
   double growrate_ta = 0;
@@ -291,7 +290,7 @@ void FixPGrowthTA::growth(double dt, int gflag) {
   for (int i = 0; i < nlocal; i++) {
 	if (mask[i] & groupbit) {
 	  int t = type[i];
-	  int grid = kinetics->position(i); //find grid that atom is in
+	  int grid = kinetics->atom_cell[i]; //find grid that atom is in
 
 	  double density = rmass[i] / (four_thirds_pi * radius[i] * radius[i] * radius[i]);
 
@@ -318,12 +317,12 @@ void FixPGrowthTA::growth(double dt, int gflag) {
 		//rmass[i] = rmass[i] + (growrate_ta - growrate_d) * rmass[i] * dt;
         rmass[i] = rmass[i] + rmass[i] * (1 + (growrate_ta - growrate_d) * dt);
 		//printf("rmass ta cell %i is now %e\n", i, rmass[i]);
-		radius[i] = pow(three_quarters_pi * (rmass[i] / density), third);
+		radius[i] = cbrt(three_quarters_pi * (rmass[i] / density));
 		//printf("radius ta cell %i is now %e\n", i, radius[i]);
         //outer mass & radius is for sc to ta
 		outer_mass[i] = four_thirds_pi * (outer_radius[i] * outer_radius[i] * outer_radius[i] - radius[i] * radius[i] * radius[i]) * ta_dens + growrate_d * rmass[i] * dt;
 		//printf("outer mass ta cell %i is %e\n", i, outer_mass[i]);
-		outer_radius[i] =  pow(three_quarters_pi * (rmass[i] / density + outer_mass[i] / ta_dens), third);
+		outer_radius[i] =  cbrt(three_quarters_pi * (rmass[i] / density + outer_mass[i] / ta_dens));
 		//printf("outer radius ta cell %i is %e\n", i, outer_radius[i]);
       }
     }
@@ -259,7 +259,7 @@ void FixPGrowthTCELL::growth(double dt, int gflag) {
   for (int i = 0; i < nlocal; i++) {
 	if (mask[i] & groupbit) {
 	  int t = type[i];
-	  int grid = kinetics->position(i); //find grid that atom is in
+	  int grid = kinetics->atom_cell[i]; //find grid that atom is in
 
 	  double density = rmass[i] / (four_thirds_pi * radius[i] * radius[i] * radius[i]);
 
@@ -318,17 +318,16 @@ double FixPGrowthTCELL::calculate_gridmass(int grid_id){ // to edit
 int FixPGrowthTCELL::calculate_gridcell(int grid_id, int t){
 	int cell_count = 0;
 	int *mask = atom->mask;
-	int nlocal = atom->nlocal;
 	int *type = atom->type;
 
-	for (int i = 0; i < nlocal; i++) {
-		if (mask[i] & groupbit) {
-			int pos = kinetics->position(i);
-
-			//if it is within the same grid and is the targeted cell type, add 1
-			if (pos == grid_id && t == type[i]){
-				cell_count += 1;
-			}
+	// only the atoms binned to grid_id need to be visited
+	kinetics->update_bins();
+	int *cell_atoms = kinetics->cell_atoms;
+	for (int j = kinetics->cell_start[grid_id]; j < kinetics->cell_start[grid_id + 1]; j++) {
+		int i = cell_atoms[j];
+		//if it is the targeted cell type, add 1
+		if ((mask[i] & groupbit) && t == type[i]){
+			cell_count += 1;
 		}
 	}
 //	printf("type: %i cell count in grid %d is %d \n", t, grid_id, cell_count);